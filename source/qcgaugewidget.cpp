@@ -32,9 +32,22 @@
 
 #include <QPainter>
 #include <QtMath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
 #include <QResizeEvent>
+#include <QTimerEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QGraphicsBlurEffect>
 #include <QLabel>
+#include <QVarLengthArray>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QTimer>
+#include <QFontDatabase>
 
 #include <qtlabb/common/qtlabb_diag.h>
 #include <qtlabb/common/StreamHelpers.h>
@@ -51,91 +64,274 @@ QT_END_NAMESPACE
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Header in front of each item allocated by QcItem::operator new
+ */
+struct QcItemHeader
+{
+	QcItemStorage* Storage; ///< pools of the item or 0 for heap items
+	int Pool; ///< index of the pool in Storage
+};
+
+static const int ItemAlignment = 16;
+static const int ItemHeaderSize = (sizeof(QcItemHeader) + ItemAlignment - 1)
+	& ~(ItemAlignment - 1);
+static const int MaxSlabSlots = 64;
+
+
+/**
+ * Item pools of a gauge widget.
+ * There is one pool per item size, so all items of a type share a pool.
+ * A pool stores its items in slabs of slots and keeps the free slots in a
+ * list that runs through the slots, so the slot of a deleted item is reused
+ * by the next item of the same type. The storage is referenced by the
+ * widget and by each pooled item and deletes itself with the last
+ * reference.
+ */
+class QcItemStorage
+{
+public:
+	QcItemStorage() : mReferences(1) {}
+
+	~QcItemStorage()
+	{
+		for (int i = 0; i < mPools.size(); ++i)
+		{
+			const QVector<char*>& Slabs = mPools.at(i).Slabs;
+			for (int j = 0; j < Slabs.size(); ++j)
+			{
+				::operator delete(Slabs.at(j));
+			}
+		}
+	}
+
+	/**
+	 * Returns a slot of SlotSize bytes including the item header
+	 */
+	void* allocate(int SlotSize)
+	{
+		int Index = 0;
+		while (Index < mPools.size() && mPools.at(Index).SlotSize != SlotSize)
+		{
+			++Index;
+		}
+		if (Index == mPools.size())
+		{
+			Pool NewPool;
+			NewPool.SlotSize = SlotSize;
+			NewPool.SlabSlots = 0;
+			NewPool.FreeList = 0;
+			mPools.append(NewPool);
+		}
+
+		Pool& ItemPool = mPools[Index];
+		if (!ItemPool.FreeList)
+		{
+			grow(ItemPool);
+		}
+		char* Slot = ItemPool.FreeList;
+		ItemPool.FreeList = *reinterpret_cast<char**>(Slot);
+		QcItemHeader* Header = reinterpret_cast<QcItemHeader*>(Slot);
+		Header->Storage = this;
+		Header->Pool = Index;
+		mReferences++;
+		return Slot;
+	}
+
+	/**
+	 * Returns the slot of a destroyed item to its pool
+	 */
+	void freeSlot(QcItemHeader* Header)
+	{
+		Pool& ItemPool = mPools[Header->Pool];
+		char* Slot = reinterpret_cast<char*>(Header);
+		*reinterpret_cast<char**>(Slot) = ItemPool.FreeList;
+		ItemPool.FreeList = Slot;
+		release();
+	}
+
+	void release()
+	{
+		if (--mReferences == 0)
+		{
+			delete this;
+		}
+	}
+
+private:
+	struct Pool
+	{
+		int SlotSize; ///< bytes of header and item
+		int SlabSlots; ///< number of slots of the last slab
+		char* FreeList; ///< first free slot
+		QVector<char*> Slabs;
+	};
+
+	void grow(Pool& ItemPool)
+	{
+		// a typical gauge has a few items of each type, so the first slab
+		// is small and the following slabs grow geometrically
+		ItemPool.SlabSlots = qBound(4, ItemPool.SlabSlots * 2, MaxSlabSlots);
+		char* Slab = static_cast<char*>(::operator new(
+			size_t(ItemPool.SlabSlots) * ItemPool.SlotSize));
+		ItemPool.Slabs.append(Slab);
+		for (int i = ItemPool.SlabSlots - 1; i >= 0; --i)
+		{
+			char* Slot = Slab + i * ItemPool.SlotSize;
+			*reinterpret_cast<char**>(Slot) = ItemPool.FreeList;
+			ItemPool.FreeList = Slot;
+		}
+	}
+
+	QVector<Pool> mPools;
+	int mReferences; ///< the widget and all pooled items
+};
+
+
 QcGaugeWidget::QcGaugeWidget(QWidget *parent) :
     QWidget(parent),
     mUpdateBufferImages(true),
-    mBorderPen(Qt::NoPen)
-{
-
+    mBackgroundDirty(false),
+    mForegroundDirty(false),
+    mFirstDynamicIndex(-1),
+    mLastDynamicIndex(-1),
+    mSingleNeedle(0),
+    mStaticItemCount(0),
+    mStaticFirstDynamic(-1),
+    mStaticLastDynamic(-1),
+    mBorderPen(Qt::NoPen),
+    mUpdateLockCount(0),
+    mUpdatePending(false),
+    mValuesPending(false),
+    mQualityGovernorEnabled(false),
+    mQualityLevel(FullQuality),
+    mFrameBudget(8),
+    mAveragePaintTime(0),
+    mAverageFrameTime(0),
+    mOverBudgetFrames(0),
+    mUnderBudgetFrames(0),
+    mScheduler(0),
+    mPriority(0),
+    mMinimumRefreshRate(1),
+    mMaximumRefreshRate(60),
+    mSchedulerDirty(false),
+    mDormant(true),
+    mShowsPlaceholder(false),
+    mSchedulerRender(false),
+    mLayersRendered(false),
+    mCachePrev(0),
+    mCacheNext(0),
+    mCacheFrame(0),
+    mCompactLayerFormats(false),
+    mDormantCacheTimeout(-1),
+    mGeometryRevision(0),
+    mFastNeedleRendering(false),
+    mParallelRenderingThreshold(1024),
+    mFlashPhase(false),
+    mRepaintDeadline(0),
+    mItemStorage(0)
+{
+	updateGaugeRect();
 }
 
 
 QcGaugeWidget::~QcGaugeWidget()
 {
+	if (mScheduler)
+	{
+		mScheduler->removeGauge(this);
+	}
+	QcCacheManager::instance()->removeWidget(this);
 	qDeleteAll(mItems);
+	if (mItemStorage)
+	{
+		// the pools stay alive for items that have been removed from the list
+		mItemStorage->release();
+	}
 }
 
 QcBackgroundItem *QcGaugeWidget::addBackground(double position)
 {
-    QcBackgroundItem * item = new QcBackgroundItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcBackgroundItem * item = new (this) QcBackgroundItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcDegreesItem *QcGaugeWidget::addDegrees(double position)
 {
-    QcDegreesItem * item = new QcDegreesItem(this);
-    item->setPosition(position);
-
-    mItems.append(item);
+    QcDegreesItem * item = new (this) QcDegreesItem(this);
+    addItem(item, position);
     return item;
 }
 
 
 QcValuesItem *QcGaugeWidget::addValues(double position)
 {
-    QcValuesItem * item = new QcValuesItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcValuesItem * item = new (this) QcValuesItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcArcItem *QcGaugeWidget::addArc(double position)
 {
-    QcArcItem * item = new QcArcItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcArcItem * item = new (this) QcArcItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcColorBand *QcGaugeWidget::addColorBand(double position)
 {
-    QcColorBand * item = new QcColorBand(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcColorBand * item = new (this) QcColorBand(this);
+    addItem(item, position);
     return item;
 }
 
 QcNeedleItem *QcGaugeWidget::addNeedle(double position)
 {
-    QcNeedleItem * item = new QcNeedleItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcNeedleItem * item = new (this) QcNeedleItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcLabelItem *QcGaugeWidget::addLabel(double position)
 {
-    QcLabelItem * item = new QcLabelItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcLabelItem * item = new (this) QcLabelItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcGlassItem *QcGaugeWidget::addGlass(double position)
 {
-    QcGlassItem * item = new QcGlassItem(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcGlassItem * item = new (this) QcGlassItem(this);
+    addItem(item, position);
     return item;
 }
 
 QcAltitudeMeter *QcGaugeWidget::addAltitudeMeter(double position)
 {
-    QcAltitudeMeter * item = new QcAltitudeMeter(this);
-    item->setPosition(position);
-    mItems.append(item);
+    QcAltitudeMeter * item = new (this) QcAltitudeMeter(this);
+    addItem(item, position);
+    return item;
+}
+
+QcRotatingDialItem *QcGaugeWidget::addRotatingDial(double position)
+{
+    QcRotatingDialItem * item = new (this) QcRotatingDialItem(this);
+    addItem(item, position);
+    return item;
+}
+
+QcTapeItem *QcGaugeWidget::addTape(double position)
+{
+    QcTapeItem * item = new (this) QcTapeItem(this);
+    addItem(item, position);
+    return item;
+}
+
+QcHistoryItem *QcGaugeWidget::addHistory(double position)
+{
+    QcHistoryItem * item = new (this) QcHistoryItem(this);
+    addItem(item, position);
     return item;
 }
 
@@ -143,6 +339,8 @@ void QcGaugeWidget::addItem(QcItem *item, double position)
 {
     item->setPosition(position);
     mItems.append(item);
+    mUpdateBufferImages = true;
+    scheduleUpdate();
 }
 
 bool QcGaugeWidget::removeItem(QcItem *item)
@@ -154,6 +352,8 @@ bool QcGaugeWidget::removeItem(QcItem *item)
 		if (*it == item)
 		{
 			mItems.erase(it);
+			mUpdateBufferImages = true;
+			scheduleUpdate();
 			return true;
 		}
 	}
@@ -161,6 +361,65 @@ bool QcGaugeWidget::removeItem(QcItem *item)
 	return false;
 }
 
+void QcGaugeWidget::insertStaticItems(QcItem* const* Items, int Count,
+	int FirstDynamic, int LastDynamic)
+{
+	for (int i = Count - 1; i >= 0; --i)
+	{
+		mItems.prepend(Items[i]);
+	}
+	mStaticItemCount = Count;
+	mStaticFirstDynamic = FirstDynamic;
+	mStaticLastDynamic = LastDynamic;
+	mUpdateBufferImages = true;
+	scheduleUpdate();
+}
+
+
+void QcGaugeWidget::removeStaticItems(QcItem* const* Items, int Count)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		mItems.removeOne(Items[i]);
+	}
+	mStaticItemCount = 0;
+	mStaticFirstDynamic = -1;
+	mStaticLastDynamic = -1;
+	mUpdateBufferImages = true;
+}
+
+
+void QcGaugeWidget::drawDynamicItems(QPainter* Painter, int First, int Last)
+{
+	for (int i = First; i <= Last; ++i)
+	{
+		drawItem(Painter, i);
+	}
+}
+
+
+void QcGaugeWidget::drawItem(QPainter* Painter, int Index)
+{
+	// static items between dynamic items are blitted from their
+	// retained images
+	QcItem* Item = mItems.at(Index);
+	if (Item->isDynamic())
+	{
+		Item->draw(Painter);
+	}
+	else
+	{
+		Item->drawCached(Painter);
+	}
+}
+
+
+void QcGaugeWidget::drawCachedItem(QcItem* Item, QPainter* Painter)
+{
+	Item->drawCached(Painter);
+}
+
+
 QList<QcItem *> QcGaugeWidget::items()
 {
     return mItems;
@@ -178,1430 +437,5517 @@ int QcGaugeWidget::diameter() const
 }
 
 
-QImage QcGaugeWidget::createBufferImage() const
+QImage QcGaugeWidget::createBufferImage(QImage::Format Format) const
 {
 	int Diameter = diameter();
-	return QImage(QSize(Diameter, Diameter), QImage::Format_ARGB32_Premultiplied);
+	return QImage(QSize(Diameter, Diameter), Format);
 }
 
 
-void QcGaugeWidget::updateBufferImages()
+void QcGaugeWidget::setCompactLayerFormats(bool Enabled)
 {
-	mNeedleItemIndex = -1;
-	mBackgroundBuffer = createBufferImage();
-	mBackgroundBuffer.fill(qRgba(0, 0, 0, 0));
-	mForegeroundBuffer = createBufferImage();
-	mForegeroundBuffer.fill(qRgba(0, 0, 0, 0));
-
-	int i = 0;
-	QPainter BackgroundPainter(&mBackgroundBuffer);
-	BackgroundPainter.setRenderHints(QPainter::Antialiasing);
-	for (; i < mItems.size(); ++i)
-	{
-		QcNeedleItem* NeedleItem = dynamic_cast<QcNeedleItem*>(mItems.at(i));
-		if (NeedleItem)
-		{
-			mNeedleItemIndex = i;
-			i++;
-			break;
-		}
-
-		mItems.at(i)->draw(&BackgroundPainter);
-	}
-
-	QPainter ForegroundPainter(&mForegeroundBuffer);
-	ForegroundPainter.setRenderHints(QPainter::Antialiasing);
-	for (; i < mItems.size(); ++i)
-	{
-		mItems.at(i)->draw(&ForegroundPainter);
-	}
-	mUpdateBufferImages = false;
+	mCompactLayerFormats = Enabled;
+	mUpdateBufferImages = true;
+	scheduleUpdate();
 }
 
 
-void QcGaugeWidget::invalidateBufferImages()
+bool QcGaugeWidget::compactLayerFormats() const
 {
-	mUpdateBufferImages = true;
+	return mCompactLayerFormats;
 }
 
 
-QImage QcGaugeWidget::blurShadowImage(QImage& Source) const
+void QcGaugeWidget::setFastNeedleRendering(bool Enabled)
 {
-	double Radius = diameter() / 2.0;
-	double BlurRadius = Radius / 20;
-	int ImageBorderSize = BlurRadius / 2;
-	QImage ExtendedSource(Source.size() + QSize(ImageBorderSize * 2, ImageBorderSize * 2), QImage::Format_ARGB32_Premultiplied);
-	ExtendedSource.fill(Qt::transparent);
+	mFastNeedleRendering = Enabled;
+	if (!Enabled)
 	{
-		QPainter Painter(&ExtendedSource);
-		Painter.drawImage(QPoint(ImageBorderSize, ImageBorderSize), Source);
+		mNeedleBuffer = QImage();
 	}
+	scheduleUpdate();
+}
 
-	QImage BlurredImage(ExtendedSource.size(), QImage::Format_ARGB32_Premultiplied);
-    BlurredImage.fill(Qt::transparent);
-    QPainter Painter(&BlurredImage);
-    qt_blurImage(&Painter, ExtendedSource, BlurRadius, false, false );//blur radius: 2px
-    return BlurredImage;
+
+bool QcGaugeWidget::fastNeedleRendering() const
+{
+	return mFastNeedleRendering;
 }
 
 
-void QcGaugeWidget::setBorderPen(const QPen& Pen)
+void QcGaugeWidget::setParallelRenderingThreshold(int Diameter)
 {
-	mBorderPen = Pen;
+	mParallelRenderingThreshold = Diameter;
 }
 
 
-QBrush QcGaugeWidget::shadowBrush() const
+int QcGaugeWidget::parallelRenderingThreshold() const
 {
-	return QBrush(QColor(0, 0, 0, 160));
+	return mParallelRenderingThreshold;
 }
 
-QPointF QcGaugeWidget::shadowOffset() const
+
+/**
+ * The band renderers run in their own pool, so they neither wait for nor
+ * block the tasks of the application in the global thread pool
+ */
+Q_GLOBAL_STATIC(QThreadPool, bandThreadPool)
+
+
+/**
+ * Returns the number of horizontal bands the retained item images are
+ * split into for parallel rendering
+ */
+int QcGaugeWidget::renderBandCount() const
 {
-	double WidgetRadius = diameter() / 2.0;
-	QPointF ShadowOffset(0.02, 0.03);
-	return ShadowOffset * WidgetRadius;
+	int Diameter = diameter();
+	if (mParallelRenderingThreshold <= 0 || Diameter < mParallelRenderingThreshold
+	 || !QFontDatabase::supportsThreadedFontRendering())
+	{
+		return 1;
+	}
+
+	// bands should not get too small to amortize the per band setup
+	int Bands = qMin(bandThreadPool()->maxThreadCount(), Diameter / 256);
+	return qMax(1, Bands);
 }
 
 
-void QcGaugeWidget::paintEvent(QPaintEvent* PaintEvent)
+/**
+ * Returns the needle if it can be rasterized or 0 if the needle needs to
+ * be painted with QPainter
+ */
+QcNeedleItem* QcGaugeWidget::fastNeedle() const
 {
-	if (mUpdateBufferImages)
+	if (!mFastNeedleRendering || !mSingleNeedle)
 	{
-		updateBufferImages();
+		return 0;
 	}
 
-	QWidget::paintEvent(PaintEvent);
-	QPainter painter(this);
-	int Radius = diameter() / 2;
-	painter.translate(rect().center().x() - Radius, rect().center().y() - Radius);
-	painter.setRenderHint(QPainter::Antialiasing);
-    painter.drawImage(QPointF(0, 0), mBackgroundBuffer);
-    if (mNeedleItemIndex)
-    {
-    	mItems.at(mNeedleItemIndex)->draw(&painter);
-    }
-    painter.drawImage(QPointF(0, 0), mForegeroundBuffer);
-    if (mBorderPen.style() != Qt::NoPen)
-    {
-    	painter.setBrush(Qt::NoBrush);
-    	painter.setPen(mBorderPen);
-    	float PenWidth = mBorderPen.width() / 2.0 + 1;
-    	QRectF EllipseRect = QRectF(contentsRect()).adjusted(PenWidth, PenWidth, -PenWidth - 1, -PenWidth - 1);
-    	painter.drawEllipse(EllipseRect);
-    }
+	return mSingleNeedle->canRasterize() ? mSingleNeedle : 0;
 }
 
 
-void QcGaugeWidget::resizeEvent(QResizeEvent* event)
+/**
+ * Paints the needle label and shadow and blits the rasterized needle. The
+ * needle is only rasterized within its bounding box.
+ */
+void QcGaugeWidget::drawFastNeedle(QPainter* Painter, QcNeedleItem* Needle)
 {
-	mUpdateBufferImages = true;
-	QWidget::resizeEvent(event);
-	emit sizeChanged(event->size());
+	double Degree = Needle->prepareFrame();
+	Needle->drawDecorations(Painter, Degree);
+	QRect Rect = Needle->rasterize(mNeedleBuffer, Degree,
+		mQualityLevel < NoNeedleAntialiasing);
+	if (!Rect.isEmpty())
+	{
+		Painter->drawImage(Rect.topLeft(), mNeedleBuffer, QRect(QPoint(0, 0), Rect.size()));
+	}
 }
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcItem::QcItem(QcGaugeWidget* ParentWidget)
-	: mGaugeWidget(ParentWidget),
-	  mPosition(50)
+
+void QcGaugeWidget::updateBufferImages()
 {
+	// the dynamic static items are known at compile time, only the added
+	// items are checked
+	mFirstDynamicIndex = mStaticFirstDynamic;
+	mLastDynamicIndex = mStaticLastDynamic;
+	for (int i = mStaticItemCount; i < mItems.size(); ++i)
+	{
+		if (mItems.at(i)->isDynamic())
+		{
+			if (mFirstDynamicIndex < 0)
+			{
+				mFirstDynamicIndex = i;
+			}
+			mLastDynamicIndex = i;
+		}
+	}
+	mSingleNeedle = (mFirstDynamicIndex >= 0 && mFirstDynamicIndex == mLastDynamicIndex)
+		? dynamic_cast<QcNeedleItem*>(mItems.at(mFirstDynamicIndex)) : 0;
 
+	if (mFirstDynamicIndex < 0)
+	{
+		composeLayer(mBackgroundBuffer, 0, mItems.size());
+		composeLayer(mForegeroundBuffer, 0, 0);
+	}
+	else
+	{
+		composeLayer(mBackgroundBuffer, 0, mFirstDynamicIndex);
+		composeLayer(mForegeroundBuffer, mLastDynamicIndex + 1, mItems.size());
+	}
+	mUpdateBufferImages = false;
+	mBackgroundDirty = false;
+	mForegroundDirty = false;
+	mLayersRendered = true;
 }
 
 
-int QcItem::type()
+/**
+ * Recomposites the given layer from the retained images of the items in
+ * the range [First, Last). Only items that have been invalidated since the
+ * last paint are redrawn.
+ * The smallest suitable image format is used for each layer. An empty layer
+ * is not allocated at all. If the widget fills its background, the
+ * background layer is opaque and does not need an alpha channel.
+ */
+void QcGaugeWidget::composeLayer(QImage& Layer, int First, int Last)
 {
-    return 50;
+	if (First >= Last)
+	{
+		Layer = QImage();
+		return;
+	}
+
+	bool Opaque = (&Layer == &mBackgroundBuffer) && autoFillBackground();
+	QImage::Format Format = QImage::Format_ARGB32_Premultiplied;
+	if (Opaque)
+	{
+		Format = mCompactLayerFormats ? QImage::Format_RGB16 : QImage::Format_RGB32;
+	}
+
+	if (Layer.size() != QSize(diameter(), diameter()) || Layer.format() != Format)
+	{
+		Layer = createBufferImage(Format);
+	}
+	if (Layer.isNull())
+	{
+		return;
+	}
+
+	if (Opaque)
+	{
+		Layer.fill(palette().color(backgroundRole()));
+	}
+	else
+	{
+		Layer.fill(Qt::transparent);
+	}
+	QPainter Painter(&Layer);
+	for (int i = First; i < Last; ++i)
+	{
+		mItems.at(i)->drawCached(&Painter);
+	}
 }
 
-void QcItem::update()
+
+void QcGaugeWidget::invalidateBufferImages()
 {
-    mGaugeWidget->update();
+	for (int i = 0; i < mItems.size(); ++i)
+	{
+		mItems.at(i)->mRevision++;
+	}
+	mUpdateBufferImages = true;
 }
 
-double QcItem::position() const
+
+void QcGaugeWidget::invalidateItem(QcItem* Item)
 {
-    return mPosition;
+	int Index = mItems.indexOf(Item);
+	if (Index >= 0 && !mUpdateBufferImages)
+	{
+		if (mFirstDynamicIndex < 0 || Index < mFirstDynamicIndex)
+		{
+			mBackgroundDirty = true;
+		}
+		else if (Index > mLastDynamicIndex)
+		{
+			mForegroundDirty = true;
+		}
+	}
+	scheduleUpdate();
 }
 
-QRectF QcItem::widgetRect() const
+
+void QcGaugeWidget::beginUpdate()
 {
-    QRectF Rect(mGaugeWidget->contentsRect().topLeft(), mGaugeWidget->contentsRect().bottomRight());
-    int Diameter = qMin(Rect.width(), Rect.height());
-    Rect.setSize(QSize(Diameter, Diameter));
-    return Rect;
+	mUpdateLockCount++;
 }
 
 
-QRectF QcItem::itemRect() const
+void QcGaugeWidget::endUpdate()
 {
-	return adjustRect(position());
+	if (mUpdateLockCount <= 0)
+	{
+		return;
+	}
+
+	mUpdateLockCount--;
+	if (!mUpdateLockCount && mUpdatePending)
+	{
+		mUpdatePending = false;
+		update();
+	}
 }
 
 
-void QcItem::setPosition(double position)
+bool QcGaugeWidget::isUpdating() const
 {
-    if(position>100)
-        mPosition = 100;
-    else if(position<0)
-        mPosition = 0;
-    else
-        mPosition = position;
-    update();
+	return mUpdateLockCount > 0;
 }
 
 
-QRectF QcItem::adjustRect(double percentage) const
-{
-	QRectF Rect = widgetRect().adjusted(2, 2, -2, -2);
-    double r = getRadius(Rect);
-    double offset =   r - (percentage * r) / 100.0;
-    QRectF Result = Rect.adjusted(offset, offset, -offset, -offset);
-    return Result;
-}
+/**
+ * Minimum interval between two repaints in the ReducedUpdateRate quality
+ * level
+ */
+static const int ReducedUpdateInterval = 100;
 
-double QcItem::getRadius(const QRectF &tmpRect)
-{
-    double Diameter = qMin(tmpRect.width(), tmpRect.height());
-    return Diameter / 2.0;
-}
+/**
+ * Interval of the alarm flash in ms
+ */
+static const int AlarmFlashInterval = 250;
 
 
-QPointF QcItem::getPoint(double deg,const QRectF &tmpRect)
+/**
+ * Adds Band to or removes it from the bands with a flashing alarm overlay.
+ * The flash timer only runs while a band is flashing.
+ */
+void QcGaugeWidget::setAlarmFlashing(QcColorBand* Band, bool Flashing)
 {
-    double r = getRadius(tmpRect);
-    double xx=cos(qDegreesToRadians(deg))*r;
-    double yy=sin(qDegreesToRadians(deg))*r;
-    QPointF pt;
-    xx=tmpRect.center().x()-xx;
-    yy=tmpRect.center().y()-yy;
-    pt.setX(xx);
-    pt.setY(yy);
-    return pt;
+	// the list has been reserved by QcColorBand::setAlarmFlashing(), so
+	// the alarm evaluation does not allocate
+	int Index = mFlashingBands.indexOf(Band);
+	if (Flashing && Index < 0)
+	{
+		mFlashingBands.append(Band);
+		if (!mFlashTimer.isActive())
+		{
+			mFlashPhase = true;
+			mFlashTimer.start(AlarmFlashInterval, this);
+			scheduleUpdate();
+		}
+	}
+	else if (!Flashing && Index >= 0)
+	{
+		mFlashingBands.remove(Index);
+		if (mFlashingBands.isEmpty())
+		{
+			mFlashTimer.stop();
+			mFlashPhase = false;
+		}
+		scheduleUpdate();
+	}
 }
 
 
 
-double QcItem::getAngle(const QPointF&pt, const QRectF &tmpRect)
+void QcGaugeWidget::scheduleUpdate()
 {
-    double xx = tmpRect.center().x()-pt.x();
-    double yy = tmpRect.center().y()-pt.y();
-    return qRadiansToDegrees( atan2(yy,xx));
-}
+	// a dormant widget is painted when it becomes visible again
+	if (mDormant)
+	{
+		return;
+	}
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
+	if (mUpdateLockCount)
+	{
+		mUpdatePending = true;
+		return;
+	}
 
-QcScaleItem::QcScaleItem(QcGaugeWidget* ParentWidget) :
-    QcItem(ParentWidget),
-    mMinValue(0),
-    mMaxValue(100),
-    mMinDegree(-45),
-    mMaxDegree(225)
-{
+	if (mScheduler)
+	{
+		if (!mSchedulerDirty)
+		{
+			mSchedulerDirty = true;
+			mDirtyTimer.start();
+		}
+		return;
+	}
+
+	if (!mUpdateRequestTimer.isValid())
+	{
+		mUpdateRequestTimer.start();
+	}
 
+	if (mQualityLevel >= ReducedUpdateRate && mLastPaintTimer.isValid())
+	{
+		qint64 Elapsed = mLastPaintTimer.elapsed();
+		if (Elapsed < ReducedUpdateInterval)
+		{
+			if (!mThrottleTimer.isActive())
+			{
+				mThrottleTimer.start(ReducedUpdateInterval - Elapsed, this);
+			}
+			return;
+		}
+	}
+	update();
 }
 
-void QcScaleItem::setRange(double minValue, double maxValue)
+
+void QcGaugeWidget::timerEvent(QTimerEvent* event)
 {
-    if(!(minValue<maxValue))
-        throw( InvalidValueRange);
-    mMinValue = minValue;
-    mMaxValue = maxValue;
-    mGaugeWidget->invalidateBufferImages();
-    update();
+	if (event->timerId() == mThrottleTimer.timerId())
+	{
+		mThrottleTimer.stop();
+		update();
+	}
+	else if (event->timerId() == mDormantTimer.timerId())
+	{
+		mDormantTimer.stop();
+		releaseCaches();
+	}
+	else if (event->timerId() == mFlashTimer.timerId())
+	{
+		mFlashPhase = !mFlashPhase;
+		scheduleUpdate();
+	}
+	else if (event->timerId() == mRepaintTimer.timerId())
+	{
+		mRepaintTimer.stop();
+		scheduleUpdate();
+	}
+	else
+	{
+		QWidget::timerEvent(event);
+	}
 }
 
-void QcScaleItem::setDegreeRange(double minDegree, double maxDegree)
+
+/**
+ * Schedules a repaint in Msecs milliseconds. A pending earlier request is
+ * kept.
+ */
+void QcGaugeWidget::requestRepaint(int Msecs)
 {
-    if(!(minDegree<maxDegree))
-        throw( InvalidValueRange);
-    mMinDegree = minDegree;
-    mMaxDegree = maxDegree;
+	if (!mRepaintClock.isValid())
+	{
+		mRepaintClock.start();
+	}
+	qint64 Deadline = mRepaintClock.elapsed() + Msecs;
+	if (mRepaintTimer.isActive() && mRepaintDeadline <= Deadline)
+	{
+		return;
+	}
+	mRepaintDeadline = Deadline;
+	mRepaintTimer.start(Msecs, this);
 }
 
-double QcScaleItem::getDegFromValue(double v) const
+
+void QcGaugeWidget::setQualityGovernorEnabled(bool Enabled)
 {
-    double a = (mMaxDegree-mMinDegree)/(mMaxValue-mMinValue);
-    double b = -a*mMinValue+mMinDegree;
-    return a*v+b;
+	mQualityGovernorEnabled = Enabled;
+	mOverBudgetFrames = 0;
+	mUnderBudgetFrames = 0;
+	if (!Enabled)
+	{
+		setQualityLevel(FullQuality);
+	}
 }
 
 
-void QcScaleItem::setMinimumValue(double minValue)
+bool QcGaugeWidget::qualityGovernorEnabled() const
 {
-    if(minValue>mMaxValue)
-        throw (InvalidValueRange);
-    mMinValue = minValue;
-    mGaugeWidget->invalidateBufferImages();
-    update();
+	return mQualityGovernorEnabled;
 }
 
 
-void QcScaleItem::setMaximumValue(double maxValue)
+void QcGaugeWidget::setFrameBudget(double Milliseconds)
 {
-    if(maxValue<mMinValue )
-        throw (InvalidValueRange);
-    mMaxValue = maxValue;
-    mGaugeWidget->invalidateBufferImages();
-    update();
+	mFrameBudget = Milliseconds;
 }
 
-void QcScaleItem::setMinimumDegree(double minDegree)
+
+double QcGaugeWidget::frameBudget() const
 {
-    if(minDegree>mMaxDegree)
-        throw (InvalidDegreeRange);
-    mMinDegree = minDegree;
-    update();
+	return mFrameBudget;
 }
-void QcScaleItem::setMaximumDegree(double maxDegree)
+
+
+void QcGaugeWidget::setQualityLevel(QualityLevel Level)
 {
-    if(maxDegree<mMinDegree)
-        throw (InvalidDegreeRange);
-    mMaxDegree = maxDegree;
-    update();
+	if (Level == mQualityLevel)
+	{
+		return;
+	}
+
+	mQualityLevel = Level;
+	emit qualityLevelChanged(Level);
+	scheduleUpdate();
 }
 
 
-double QcScaleItem::maximumDegree() const
+QcGaugeWidget::QualityLevel QcGaugeWidget::qualityLevel() const
 {
-	return mMaxDegree;
+	return mQualityLevel;
 }
 
 
-double QcScaleItem::minimumDegree() const
+double QcGaugeWidget::averagePaintTime() const
 {
-	return mMinDegree;
+	return mAveragePaintTime;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcBackgroundItem::QcBackgroundItem(QcGaugeWidget* ParentWidget) :
-    QcItem(ParentWidget),
-    mBrush(Qt::darkGray)
+void QcGaugeWidget::setPriority(int Priority)
 {
-    setPosition(88);
-    mPen = Qt::NoPen;
-    setPosition(88);
-
-    addColor(0.4,Qt::darkGray);
-    addColor(0.8,Qt::black);
+	mPriority = Priority;
 }
 
 
-QcBackgroundItem::~QcBackgroundItem()
+int QcGaugeWidget::priority() const
 {
-
+	return mPriority;
 }
 
 
-void QcBackgroundItem::draw(QPainter* painter)
+void QcGaugeWidget::setRefreshRateRange(double MinimumRate, double MaximumRate)
 {
-    QRectF tmpRect = widgetRect();
+	if (!(MinimumRate > 0 && MinimumRate <= MaximumRate))
+		throw (QcItem::InvalidValueRange);
+	mMinimumRefreshRate = MinimumRate;
+	mMaximumRefreshRate = MaximumRate;
+}
 
-    if (mDropShadow)
-    {
-		QPointF ShadowOffset = mGaugeWidget->shadowOffset();
-		painter->save();
-		painter->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-		painter->translate(-(mDropShadowImage.width() / 2.0) + ShadowOffset.x(),
-			-(mDropShadowImage.height() / 2.0) +  ShadowOffset.y());
-		painter->drawImage(itemRect().center(), mDropShadowImage);
-		painter->restore();
-    }
 
-    if (!mColors.empty())
-    {
-		QLinearGradient linearGrad(tmpRect.topLeft(), tmpRect.bottomRight());
-		for(int i = 0;i<mColors.size();i++){
-			linearGrad.setColorAt(mColors[i].first,mColors[i].second);
-		}
-		painter->setBrush(linearGrad);
-    }
-    else
-    {
-    	painter->setBrush(mBrush);
-    }
+double QcGaugeWidget::minimumRefreshRate() const
+{
+	return mMinimumRefreshRate;
+}
 
-    painter->setPen(mPen);
-    painter->drawEllipse(itemRect());
+
+double QcGaugeWidget::maximumRefreshRate() const
+{
+	return mMaximumRefreshRate;
 }
 
-void QcBackgroundItem::addColor(double position, const QColor &color)
+
+QcDashboardScheduler* QcGaugeWidget::scheduler() const
 {
-    if(position<0||position>1)
-        return;
-      QPair<double,QColor> pair;
-      pair.first = position;
-      pair.second = color;
-      mColors.append(pair);
-      update();
+	return mScheduler;
 }
 
-void QcBackgroundItem::clearColors()
+
+bool QcGaugeWidget::isDormant() const
 {
-    mColors.clear();
+	return mDormant;
 }
 
 
-void QcBackgroundItem::setDropShadow(bool DropShadow)
+void QcGaugeWidget::setDormantCacheTimeout(int Milliseconds)
 {
-	mDropShadow = DropShadow;
-	if (DropShadow)
+	mDormantCacheTimeout = Milliseconds;
+	if (Milliseconds < 0)
 	{
-		updateDropShadowImage();
-		connect(mGaugeWidget, SIGNAL(sizeChanged(const QSize&)), this,
-			SLOT(onWidgetSizeChanged(const QSize&)));
+		mDormantTimer.stop();
 	}
-	else
+	else if (mDormant)
 	{
-		mDropShadowImage = QImage();
-		disconnect(mGaugeWidget, SIGNAL(sizeChanged(const QSize&)), this,
-			SLOT(onWidgetSizeChanged(const QSize&)));
+		mDormantTimer.start(Milliseconds, this);
 	}
 }
 
 
-bool QcBackgroundItem::dropShadow() const
+int QcGaugeWidget::dormantCacheTimeout() const
 {
-	return mDropShadow;
+	return mDormantCacheTimeout;
 }
 
 
-void QcBackgroundItem::onWidgetSizeChanged(const QSize& Size)
+void QcGaugeWidget::releaseCaches()
 {
-	updateDropShadowImage();
+	mBackgroundBuffer = QImage();
+	mForegeroundBuffer = QImage();
+	mNeedleBuffer = QImage();
+	for (int i = 0; i < mItems.size(); ++i)
+	{
+		mItems.at(i)->releaseCache();
+	}
+	mUpdateBufferImages = true;
+	mLayersRendered = false;
+	QcCacheManager::instance()->updateUsage(this, 0);
 }
 
 
-void QcBackgroundItem::updateDropShadowImage()
+/**
+ * Returns the number of bytes of the pixel data of Image
+ */
+static qint64 imageBytes(const QImage& Image)
 {
-	if (!mDropShadow)
+	return qint64(Image.bytesPerLine()) * Image.height();
+}
+
+
+qint64 QcGaugeWidget::cacheSize() const
+{
+	qint64 Bytes = imageBytes(mBackgroundBuffer) + imageBytes(mForegeroundBuffer)
+		+ imageBytes(mNeedleBuffer);
+	for (int i = 0; i < mItems.size(); ++i)
 	{
-		return;
+		Bytes += mItems.at(i)->cacheSize();
 	}
-
-	QRectF tmpRect = itemRect();
-	tmpRect.moveTopLeft(QPointF(0, 0));
-	QImage ShadowImage(tmpRect.size().toSize(), QImage::Format_ARGB32_Premultiplied);
-    ShadowImage.fill(Qt::transparent);
-    {
-    	QPainter Painter(&ShadowImage);
-		Painter.setRenderHint(QPainter::Antialiasing);
-		Painter.setBrush(QColor(0, 0, 0, 160));
-		Painter.setPen(Qt::NoPen);
-		Painter.drawEllipse(tmpRect);
-    }
-    mDropShadowImage = mGaugeWidget->blurShadowImage(ShadowImage);
+	return Bytes;
 }
 
 
-void QcBackgroundItem::setBrush(const QBrush& Brush)
+void QcGaugeWidget::showEvent(QShowEvent* event)
 {
-	mBrush = Brush;
-	update();
+	QWidget::showEvent(event);
+	mDormantTimer.stop();
+	if (mDormant)
+	{
+		// catch up with all changes stored while dormant in a single paint
+		mDormant = false;
+		update();
+	}
 }
 
-const QBrush& QcBackgroundItem::brush() const
+
+void QcGaugeWidget::hideEvent(QHideEvent* event)
 {
-	return mBrush;
+	QWidget::hideEvent(event);
+	mDormant = true;
+	QcCacheManager::instance()->widgetHidden(this);
+	if (mDormantCacheTimeout >= 0)
+	{
+		mDormantTimer.start(mDormantCacheTimeout, this);
+	}
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcGlassItem::QcGlassItem(QcGaugeWidget* ParentWidget) :
-    QcItem(ParentWidget),
-    mGlassType(CurvedGlass2)
+/**
+ * Returns a positive weight that increases with the priority of a gauge
+ */
+static double priorityWeight(int Priority)
 {
-    setPosition(88);
+	return (Priority >= 0) ? 1.0 + Priority : 1.0 / (1 - Priority);
 }
 
-void QcGlassItem::draw(QPainter *painter)
+
+/**
+ * Feeds the paint and frame time of the last frame into the quality
+ * governor. The level is lowered if the average frame time is above the
+ * budget for several frames and raised again if it stays below half of the
+ * budget for a longer period.
+ */
+void QcGaugeWidget::updateQualityLevel(double PaintTime, double FrameTime)
 {
-    QColor clr1(Qt::white);
-    QLinearGradient linearGrad1;
-    linearGrad1.setCoordinateMode(QGradient::ObjectBoundingMode);
-    linearGrad1.setStart(0,0);
-    linearGrad1.setFinalStop(0,1);
-    clr1.setAlphaF(0.7);
-    linearGrad1.setColorAt(0, clr1);
-    clr1.setAlphaF(0.35);
-    linearGrad1.setColorAt(0.4, clr1);
-    clr1.setAlphaF(0.15);
-    linearGrad1.setColorAt(1, clr1);
+	mAveragePaintTime = mAveragePaintTime * 0.9 + PaintTime * 0.1;
+	if (mScheduler)
+	{
+		// the scheduler governs the quality of all its gauges
+		return;
+	}
+	mAverageFrameTime = mAverageFrameTime * 0.9 + FrameTime * 0.1;
+	if (!mQualityGovernorEnabled)
+	{
+		return;
+	}
 
-	QPainterPath Path;
-	QBrush Brush(linearGrad1);
-	switch (mGlassType)
+	// gauges with a lower priority degrade first and restore last
+	double Weight = priorityWeight(mPriority);
+	int DegradeFrames = qMax(1, qRound(10 * Weight));
+	int RestoreFrames = qMax(1, qRound(60 / Weight));
+	if (mAverageFrameTime > mFrameBudget)
 	{
-		case StronglyCurvedGlass: createStronglyCurvedGlass(Path, Brush); break;
-		case CurvedGlass1: createCurvedGlass1(Path, Brush); break;
-		case CurvedGlass2: createCurvedGlass2(Path, Brush); break;
-		case FlatGlass: createFlatGlass(Path, Brush); break;
-		case FlatGlass2: createFlatGlass2(Path, Brush); break;
-		default:
-			createStronglyCurvedGlass(Path, Brush); break;
+		mUnderBudgetFrames = 0;
+		if (++mOverBudgetFrames >= DegradeFrames && mQualityLevel < NoLabelUpdate)
+		{
+			mOverBudgetFrames = 0;
+			setQualityLevel(static_cast<QualityLevel>(mQualityLevel + 1));
+		}
+	}
+	else if (mAverageFrameTime < mFrameBudget / 2)
+	{
+		mOverBudgetFrames = 0;
+		if (++mUnderBudgetFrames >= RestoreFrames && mQualityLevel > FullQuality)
+		{
+			mUnderBudgetFrames = 0;
+			setQualityLevel(static_cast<QualityLevel>(mQualityLevel - 1));
+		}
+	}
+	else
+	{
+		mOverBudgetFrames = 0;
+		mUnderBudgetFrames = 0;
 	}
-    painter->setBrush(Brush);
-    painter->setPen(Qt::NoPen);
-    painter->drawPath(Path);
 }
 
 
-void QcGlassItem::setGlassType(GlassType glassType)
+QImage QcGaugeWidget::blurShadowImage(QImage& Source) const
 {
-	mGlassType = glassType;
+	double Radius = diameter() / 2.0;
+	double BlurRadius = Radius / 20;
+	int ImageBorderSize = BlurRadius / 2;
+	QImage ExtendedSource(Source.size() + QSize(ImageBorderSize * 2, ImageBorderSize * 2), QImage::Format_ARGB32_Premultiplied);
+	ExtendedSource.fill(Qt::transparent);
+	{
+		QPainter Painter(&ExtendedSource);
+		Painter.drawImage(QPoint(ImageBorderSize, ImageBorderSize), Source);
+	}
+
+	QImage BlurredImage(ExtendedSource.size(), QImage::Format_ARGB32_Premultiplied);
+    BlurredImage.fill(Qt::transparent);
+    QPainter Painter(&BlurredImage);
+    qt_blurImage(&Painter, ExtendedSource, BlurRadius, false, false );//blur radius: 2px
+    return BlurredImage;
 }
 
 
-void QcGlassItem::createStronglyCurvedGlass(QPainterPath& Path,
-	QBrush& Brush)
+/**
+ * Shadows are painted with a flat colour. If this colour is black, only the
+ * alpha channel carries information and the shadow is stored as Alpha8
+ * image, which is drawn as black with the stored alpha.
+ */
+static QImage compactShadowImage(const QImage& Shadow, const QBrush& ShadowBrush)
 {
-    static const double Angle = 2;
-
-	QRectF tmpRect1 = itemRect();
-    QPointF Start = getPoint(Angle, tmpRect1);
-    QPointF End = getPoint(180 - Angle, tmpRect1);
-    Path.moveTo(End);
-    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
-	QRectF tmpRect2;
-	tmpRect2.setWidth(qAbs(End.x() - Start.x()));
-	tmpRect2.setHeight(tmpRect1.height() / 5);
-	tmpRect2.moveCenter(QPointF(tmpRect1.center().x(), Start.y()));
-	Path.arcTo(tmpRect2, 180, 180);
+	QColor Color = ShadowBrush.color();
+	if (Color.red() || Color.green() || Color.blue())
+	{
+		return Shadow;
+	}
+	return Shadow.convertToFormat(QImage::Format_Alpha8);
 }
 
 
-void QcGlassItem::createCurvedGlass1(QPainterPath& Path,
-	QBrush& Brush)
+void QcGaugeWidget::setBorderPen(const QPen& Pen)
 {
-    static const double Angle = 0;
-
-	QRectF tmpRect1 = itemRect();
-    QPointF Start = getPoint(Angle, tmpRect1);
-    QPointF End = getPoint(180 - Angle, tmpRect1);
-    Path.moveTo(End);
-    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
-    Path.quadTo(QPointF(tmpRect1.center().x(), Start.y() + tmpRect1.height() / 7), End);
+	mBorderPen = Pen;
 }
 
 
-void QcGlassItem::createCurvedGlass2(QPainterPath& Path,
-	QBrush& Brush)
+QBrush QcGaugeWidget::shadowBrush() const
 {
-    static const double Angle = 5;
-
-	QRectF tmpRect1 = itemRect();
-    QPointF Start = getPoint(Angle, tmpRect1);
-    QPointF End = getPoint(180 - Angle, tmpRect1);
-    Path.moveTo(End);
-    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
-    Path.quadTo(QPointF(tmpRect1.center().x(), Start.y() - tmpRect1.height() / 7), End);
+	return QBrush(QColor(0, 0, 0, 160));
 }
 
-
-void QcGlassItem::createFlatGlass(QPainterPath& Path,
-	QBrush& Brush)
+QPointF QcGaugeWidget::shadowOffset() const
 {
-	QRectF tmpRect1 = itemRect();
-    QColor clr1 = Qt::white;
-    QColor clr2 = Qt::white;
-    clr1.setAlphaF(0.6);
-    clr2.setAlphaF(0.1);
-
-    QLinearGradient linearGrad1(QPointF(0, tmpRect1.top()), QPointF(0, tmpRect1.bottom()));
-    linearGrad1.setColorAt(0, clr1);
-    linearGrad1.setColorAt(1, clr2);
-    Brush = QBrush(linearGrad1);
-
-    QPointF End = getPoint(100, tmpRect1);
-    Path.moveTo(End);
-    Path.arcTo(tmpRect1, 80, 160);
+	double WidgetRadius = diameter() / 2.0;
+	QPointF ShadowOffset(0.02, 0.03);
+	return ShadowOffset * WidgetRadius;
 }
 
 
-void QcGlassItem::createFlatGlass2(QPainterPath& Path, QBrush& Brush)
+void QcGaugeWidget::paintEvent(QPaintEvent* PaintEvent)
 {
-    static const double Angle = 10;
-    QRectF tmpRect1 = itemRect();
+	QElapsedTimer PaintTimer;
+	PaintTimer.start();
+	// frames that rebuild the item caches are not steady state and are not
+	// fed into the quality governor
+	bool Regenerate = mUpdateBufferImages || mBackgroundDirty || mForegroundDirty;
+	if (mUpdateBufferImages && !mLayersRendered && !mSchedulerRender && mScheduler
+	 && mScheduler->isActive() && mScheduler->progressiveRendering())
+	{
+		QPainter Painter(this);
+		paintPlaceholder(Painter);
+		return;
+	}
+	mShowsPlaceholder = false;
+	mSchedulerRender = false;
 
-    QColor clr1(Qt::white);
-    QLinearGradient linearGrad1;
-    linearGrad1.setCoordinateMode(QGradient::ObjectBoundingMode);
-    linearGrad1.setStart(0,0);
-    linearGrad1.setFinalStop(0, 0.7);
-    clr1.setAlphaF(0.7);
-    linearGrad1.setColorAt(0, clr1);
-    clr1.setAlphaF(0.3);
-    linearGrad1.setColorAt(0.4, clr1);
-    clr1.setAlphaF(0.2);
-    linearGrad1.setColorAt(1, clr1);
-    Brush = QBrush(linearGrad1);
+	if (mUpdateBufferImages)
+	{
+		updateBufferImages();
+	}
+	else
+	{
+		if (mBackgroundDirty)
+		{
+			composeLayer(mBackgroundBuffer, 0,
+				(mFirstDynamicIndex < 0) ? mItems.size() : mFirstDynamicIndex);
+			mBackgroundDirty = false;
+		}
+		if (mForegroundDirty)
+		{
+			composeLayer(mForegeroundBuffer, mLastDynamicIndex + 1, mItems.size());
+			mForegroundDirty = false;
+		}
+	}
 
-    QPointF Start = getPoint(Angle, tmpRect1);
-    QPointF End = getPoint(180 - Angle, tmpRect1);
-    Path.moveTo(End);
-    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
-    Path.cubicTo(QPointF(tmpRect1.center().x(), tmpRect1.center().y() + tmpRect1.height() / 12 ),
-    	QPointF(tmpRect1.center().x() + tmpRect1.width() / 8, End.y() - tmpRect1.height() / 4),
-    	QPointF(End.x(), Start.y()));
-}
+	QWidget::paintEvent(PaintEvent);
+	QPainter painter(this);
+	int Radius = diameter() / 2;
+	painter.translate(rect().center().x() - Radius, rect().center().y() - Radius);
+	painter.setRenderHint(QPainter::Antialiasing, mQualityLevel < NoNeedleAntialiasing);
+	painter.drawImage(QPointF(0, 0), mBackgroundBuffer);
+	QcNeedleItem* FastNeedle = fastNeedle();
+	if (FastNeedle)
+	{
+		drawFastNeedle(&painter, FastNeedle);
+	}
+	else if (mFirstDynamicIndex >= 0)
+	{
+		drawDynamicItems(&painter, mFirstDynamicIndex, mLastDynamicIndex);
+	}
+    painter.drawImage(QPointF(0, 0), mForegeroundBuffer);
+    if (mFlashPhase)
+    {
+    	for (int i = 0; i < mFlashingBands.size(); ++i)
+    	{
+    		mFlashingBands.at(i)->drawAlarmOverlay(&painter);
+    	}
+    }
+    if (mBorderPen.style() != Qt::NoPen)
+    {
+    	painter.setRenderHint(QPainter::Antialiasing);
+    	painter.setBrush(Qt::NoBrush);
+    	painter.setPen(mBorderPen);
+    	float PenWidth = mBorderPen.width() / 2.0 + 1;
+    	QRectF EllipseRect = QRectF(contentsRect()).adjusted(PenWidth, PenWidth, -PenWidth - 1, -PenWidth - 1);
+    	painter.drawEllipse(EllipseRect);
+    }
 
+    mLastPaintTimer.start();
+    mSchedulerDirty = false;
+    QcCacheManager::instance()->updateUsage(this, cacheSize());
+    double PaintTime = PaintTimer.nsecsElapsed() / 1000000.0;
+    // the delay from the repaint request includes the paint time of all
+    // widgets painted before this one
+    double FrameTime = mUpdateRequestTimer.isValid()
+    	? mUpdateRequestTimer.nsecsElapsed() / 1000000.0 : PaintTime;
+    mUpdateRequestTimer.invalidate();
+    if (mScheduler)
+    {
+    	mScheduler->gaugePainted(this, PaintTime, Regenerate);
+    }
+    if (!Regenerate)
+    {
+    	updateQualityLevel(PaintTime, FrameTime);
+    }
+}
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcLabelItem::QcLabelItem(QcGaugeWidget* ParentWidget) :
-    QcItem(ParentWidget),
-    mAngle(270),
-    mText("%"),
-    mColor(Qt::black),
-    mScaleFactor(1)
+void QcGaugeWidget::onModelChanged()
 {
-    setPosition(50);
-}
+	if (mDormant)
+	{
+		return;
+	}
 
-void QcLabelItem::draw(QPainter *painter)
-{
-    QRectF tmpRect = itemRect();
-    double r = getRadius(widgetRect());
-    mFont.setPointSizeF(r / 10.0 * mScaleFactor);
-    painter->setFont(mFont);
-    painter->setPen(QPen(mColor));
+	QcGaugeModel* Model = qobject_cast<QcGaugeModel*>(sender());
 
-    QPointF txtCenter = getPoint(mAngle,tmpRect);
-    QFontMetrics fMetrics = painter->fontMetrics();
-    QSize sz = fMetrics.size( Qt::TextSingleLine, mText );
-    QRectF txtRect(QPointF(0,0), sz );
-    txtRect.moveCenter(txtCenter);
+	// only repaint if one of the needles bound to the model visibly changed
+	bool Changed = false;
+	for (int i = 0; i < mItems.size(); ++i)
+	{
+		QcNeedleItem* Needle = dynamic_cast<QcNeedleItem*>(mItems.at(i));
+		if (!Needle || !Needle->mModel || Needle->mModel != Model)
+		{
+			continue;
+		}
 
-    painter->drawText( txtRect, Qt::TextSingleLine, mText);
+		double Value = qBound(Needle->mMinValue,
+			Model->value(Needle->mModelChannel), Needle->mMaxValue);
+		if (Needle->changesVisibly(Value, Needle->getDegFromValue(Value)))
+		{
+			Changed = true;
+		}
+		else
+		{
+			Needle->mSuppressedUpdates++;
+		}
+	}
 
+	if (Changed)
+	{
+		scheduleUpdate();
+	}
 }
 
-void QcLabelItem::setAngle(double a)
-{
-    mAngle = a;
-    update();
-}
 
-double QcLabelItem::angle() const
+/**
+ * Paints a cheap placeholder for a gauge whose caches have not been built
+ * yet and queues the gauge in the dashboard scheduler
+ */
+void QcGaugeWidget::paintPlaceholder(QPainter& Painter)
 {
-    return mAngle;
+	int Diameter = diameter();
+	QRectF Rect(0, 0, Diameter, Diameter);
+	Rect.moveCenter(QRectF(rect()).center());
+	Painter.setPen(Qt::NoPen);
+	Painter.setBrush(palette().color(QPalette::Mid));
+	Painter.drawEllipse(Rect.adjusted(2, 2, -2, -2));
+
+	mShowsPlaceholder = true;
+	if (!mSchedulerDirty)
+	{
+		mSchedulerDirty = true;
+		mDirtyTimer.start();
+	}
 }
 
-void QcLabelItem::setText(const QString &text, bool repaint)
-{
-    mText = text;
-    if(repaint)
-        update();
-}
 
-const QString& QcLabelItem::text() const
+void QcGaugeWidget::resizeEvent(QResizeEvent* event)
 {
-    return mText;
+	updateGaugeRect();
+	mUpdateBufferImages = true;
+	QWidget::resizeEvent(event);
+	emit sizeChanged(event->size());
 }
 
-void QcLabelItem::setColor(const QColor &color)
+
+void QcGaugeWidget::changeEvent(QEvent* event)
 {
-    mColor = color;
-    update();
+	if (event->type() == QEvent::ContentsRectChange)
+	{
+		updateGaugeRect();
+		invalidateBufferImages();
+		scheduleUpdate();
+	}
+	QWidget::changeEvent(event);
 }
 
-const QColor& QcLabelItem::color() const
+
+/**
+ * The item rects and radii depend only on the gauge rect. Items cache them
+ * and recompute them if the geometry revision changes.
+ */
+void QcGaugeWidget::updateGaugeRect()
 {
-    return mColor;
+	QRect Contents = contentsRect();
+	mGaugeRect = QRectF(Contents.topLeft(), Contents.bottomRight());
+	int Diameter = qMin(mGaugeRect.width(), mGaugeRect.height());
+	mGaugeRect.setSize(QSize(Diameter, Diameter));
+	mGeometryRevision++;
 }
 
-void QcLabelItem::setFont(const QFont& font)
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcItem::QcItem(QcGaugeWidget* ParentWidget)
+	: mGaugeWidget(ParentWidget),
+	  mPosition(50),
+	  mRevision(1),
+	  mCacheRevision(0),
+	  mItemRectRevision(0)
 {
-	mFont = font;
+
 }
 
 
-const QFont& QcLabelItem::font() const
+int QcItem::type()
 {
-	return mFont;
+    return 50;
 }
 
 
-void QcLabelItem::setScaleFactor(float Factor)
+void* QcItem::operator new(size_t Size)
 {
-	mScaleFactor = Factor;
+	return operator new(Size, 0);
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcArcItem::QcArcItem(QcGaugeWidget* ParentWidget) :
-    QcScaleItem(ParentWidget),
-    mColor(Qt::black)
+void* QcItem::operator new(size_t Size, QcGaugeWidget* GaugeWidget)
 {
-    setPosition(80);
+	int SlotSize = ItemHeaderSize
+		+ ((int(Size) + ItemAlignment - 1) & ~(ItemAlignment - 1));
+	char* Slot;
+	if (GaugeWidget)
+	{
+		if (!GaugeWidget->mItemStorage)
+		{
+			GaugeWidget->mItemStorage = new QcItemStorage();
+		}
+		Slot = static_cast<char*>(GaugeWidget->mItemStorage->allocate(SlotSize));
+	}
+	else
+	{
+		Slot = static_cast<char*>(::operator new(SlotSize));
+		reinterpret_cast<QcItemHeader*>(Slot)->Storage = 0;
+	}
+	return Slot + ItemHeaderSize;
 }
 
-void QcArcItem::draw(QPainter *painter)
+
+void QcItem::operator delete(void* Ptr)
 {
-    QRectF tmpRect= itemRect();
-    double r = getRadius(tmpRect);
+	if (!Ptr)
+	{
+		return;
+	}
 
-    QPen pen;
-    pen.setColor(mColor);
-    pen.setWidthF(qMax(r/40.0, 1.0));
-    painter->setPen(pen);
-    painter->drawArc(tmpRect,-16*(mMinDegree+180),-16*(mMaxDegree-mMinDegree));
+	QcItemHeader* Header = reinterpret_cast<QcItemHeader*>(
+		static_cast<char*>(Ptr) - ItemHeaderSize);
+	if (Header->Storage)
+	{
+		Header->Storage->freeSlot(Header);
+	}
+	else
+	{
+		::operator delete(Header);
+	}
 }
 
-void QcArcItem::setColor(const QColor &color)
-{
-    mColor = color;
-}
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcColorBand::QcColorBand(QcGaugeWidget* ParentWidget) :
-    QcScaleItem(ParentWidget),
-    mBandStartValue(0)
+void QcItem::operator delete(void* Ptr, QcGaugeWidget*)
 {
-    QColor tmpColor;
-    tmpColor.setAlphaF(0.1);
-    QPair<QColor,double> pair;
-
-    pair.first = Qt::green;
-    pair.second = 10;
-    mBandColors.append(pair);
-
-    pair.first = Qt::darkGreen;
-    pair.second = 50;
-    mBandColors.append(pair);
-
-    pair.first = Qt::red;
-    pair.second = 100;
-    mBandColors.append(pair);
-
-    setPosition(50);
+	operator delete(Ptr);
 }
 
-QPainterPath QcColorBand::createSubBand(double from, double sweep)
-{
-    QRectF tmpRect = itemRect();
-    QPainterPath path;
-    path.arcMoveTo(tmpRect,180+from);
-    path.arcTo(tmpRect,180+from,-sweep);
-    return path;
-}
 
-void QcColorBand::draw(QPainter *painter)
-{
-    double r = getRadius(widgetRect());
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(r/20.0 * mPenWidthScaleFactor);
-    painter->setBrush(Qt::NoBrush);
-    double offset = getDegFromValue(mBandStartValue);
-    for(int i = 0;i<mBandColors.size();i++){
-        QColor clr = mBandColors[i].first;
-        double sweep;
-        if(i==0)
-            sweep = getDegFromValue(mBandColors[i].second)-getDegFromValue(mMinValue);
-        else
-            sweep = getDegFromValue(mBandColors[i].second)-getDegFromValue(mBandColors[i-1].second);
-        QPainterPath path = createSubBand(-offset,sweep);
-        offset += sweep;
-        pen.setColor(clr);
-        painter->setPen(pen);
-        painter->drawPath(path);
-    }
-}
-void QcColorBand::setColors(const QList<QPair<QColor, double> > &colors)
+void QcItem::update()
 {
-    mBandColors = colors;
-    update();
+    mGaugeWidget->scheduleUpdate();
 }
 
-void QcColorBand::setPenWidthScaleFactor(float Factor)
+
+void QcItem::updateAfter(int Msecs)
 {
-	mPenWidthScaleFactor = Factor;
+	mGaugeWidget->requestRepaint(Msecs);
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcDegreesItem::QcDegreesItem(QcGaugeWidget* ParentWidget) :
-    QcScaleItem(ParentWidget),
-    mStep(10),
-    mColor(Qt::black),
-    mSubDegree(false)
+void QcItem::invalidate()
 {
-    setPosition(90);
+	mRevision++;
+	mGaugeWidget->invalidateItem(this);
 }
 
 
-void QcDegreesItem::draw(QPainter *painter)
+quint64 QcItem::revision() const
 {
-    QRectF tmpRect = itemRect();
-
-    painter->setPen(mColor);
-    double r = getRadius(tmpRect);
-    for(double val = mMinValue;val<=mMaxValue;val+=mStep){
-        double deg = getDegFromValue(val);
-        QPointF pt = getPoint(deg,tmpRect);
-        QPainterPath path;
-        path.moveTo(pt);
-        path.lineTo(tmpRect.center());
-        pt = path.pointAtPercent(0.03);
-        QPointF newPt = path.pointAtPercent(mSubDegree ? 0.09 : 0.13);
-
-        QPen pen;
-        pen.setColor(mColor);
-        pen.setWidthF(mSubDegree ? qMax(r/75.0, 0.5) : qMax(r/25.0, 0.75));
-        painter->setPen(pen);
-        painter->drawLine(pt,newPt);
-
-    }
+	return mRevision;
 }
 
-void QcDegreesItem::setStep(double step)
-{
-    mStep = step;
-    update();
-}
 
-void QcDegreesItem::setColor(const QColor& color)
+void QcItem::releaseCache()
 {
-    mColor = color;
-    update();
+	mCacheImage = QImage();
+	mCacheRevision = 0;
 }
 
-void QcDegreesItem::setSubDegree(bool b)
+
+qint64 QcItem::cacheSize() const
 {
-    mSubDegree = b;
-    update();
+	return imageBytes(mCacheImage);
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcNeedleItem::QcNeedleItem(QcGaugeWidget* ParentWidget) :
-	QObject(0),
-    QcScaleItem(ParentWidget),
-    mCurrentValue(0),
-    mNeedleType(FeatherNeedle),
-    mLabel(0),
-    mBrush(Qt::black),
-    mDropShadow(false),
-    mThicknessFactor(1),
-    mDecimals(1)
+/**
+ * Draws Item into the lines [FirstLine, FirstLine + LineCount) of the image
+ * with the pixel data Bits. Each band paints on a full size image that
+ * shares the memory of the image and is clipped to the lines of the band.
+ * The shapes, gradients and antialiasing are computed in the coordinates
+ * of the complete image, so the band pixels are identical to the pixels of
+ * an unbanded paint, also where an antialiased edge crosses a band border.
+ * A translated band image would clip the shapes at its own border instead.
+ */
+static void drawItemBand(QcItem* Item, uchar* Bits, const QImage& Image,
+	int FirstLine, int LineCount)
 {
-	connect(ParentWidget, SIGNAL(sizeChanged(const QSize&)), this,
-		SLOT(onWidgetSizeChanged(const QSize&)));
+	QImage Band(Bits, Image.width(), Image.height(), Image.bytesPerLine(),
+		Image.format());
+	QPainter Painter(&Band);
+	Painter.setRenderHints(QPainter::Antialiasing);
+	Painter.setClipRect(0, FirstLine, Image.width(), LineCount);
+	Item->draw(&Painter);
 }
 
-void QcNeedleItem::draw(QPainter *painter)
-{
-	if (mLabel)
-	{
-		mLabel->draw(painter);
-	}
 
-    QRectF tmpRect = itemRect();
-    painter->save();
-    painter->translate(tmpRect.center());
-    double deg = getDegFromValue( mCurrentValue);
-    painter->setPen(Qt::NoPen);
+/**
+ * Draws one band of an item image in a thread of the band thread pool
+ */
+class QcBandRenderer : public QRunnable
+{
+public:
+	QcBandRenderer(QcItem* Item, uchar* Bits, const QImage& Image,
+		int FirstLine, int LineCount, QSemaphore* Done)
+		: mItem(Item),
+		  mBits(Bits),
+		  mImage(Image),
+		  mFirstLine(FirstLine),
+		  mLineCount(LineCount),
+		  mDone(Done)
+	{
 
-    double Radius = getRadius(tmpRect);
-    QPolygonF NeedlePoly = createNeedlePoly(Radius);
-    QBrush Brush(mBrush);
+	}
 
-    // draw the shadow
-    if (mDropShadow)
-    {
-		int yOffset = round((mDropShadowImage.height() - NeedlePoly.boundingRect().height()) / 2.0 - NeedlePoly.boundingRect().top());
-		painter->save();
-		painter->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-		painter->translate(mGaugeWidget->shadowOffset());
-		painter->rotate(deg + 90.0);
-		painter->translate(QPointF(0, -yOffset));
-		painter->drawImage(QPointF(-(mDropShadowImage.width() / 2), 0), mDropShadowImage);
-		painter->restore();
-    }
+	void run()
+	{
+		drawItemBand(mItem, mBits, mImage, mFirstLine, mLineCount);
+		mDone->release();
+	}
 
-    // Draw the needle
-    painter->setBrush(Brush);
-    painter->rotate(deg + 90.0);
-    painter->drawConvexPolygon(NeedlePoly);
-    painter->restore();
-}
+private:
+	QcItem* mItem;
+	uchar* mBits;
+	const QImage& mImage;
+	int mFirstLine;
+	int mLineCount;
+	QSemaphore* mDone;
+};
 
 
-void QcNeedleItem::setDropShadow(bool DropShadow)
+/**
+ * Draws the retained image of this item. The image is only redrawn if the
+ * item has been invalidated or if the widget size changed.
+ */
+void QcItem::drawCached(QPainter* painter)
 {
-	mDropShadow = DropShadow;
-	if (!DropShadow)
+	int Diameter = mGaugeWidget->diameter();
+	if (Diameter <= 0)
 	{
-		mDropShadowImage = QImage();
+		return;
 	}
-	else
+
+	if (mCacheImage.width() != Diameter || mCacheRevision != mRevision)
 	{
-		updateDropShadowImage();
+		if (mCacheImage.width() != Diameter)
+		{
+			mCacheImage = QImage(QSize(Diameter, Diameter), QImage::Format_ARGB32_Premultiplied);
+		}
+		mCacheImage.fill(Qt::transparent);
+		prepareDraw(&mCacheImage);
+		int Bands = supportsBandedDraw() ? mGaugeWidget->renderBandCount() : 1;
+		if (Bands > 1)
+		{
+			// The calling thread draws the first band while the thread pool
+			// draws the others
+			uchar* Bits = mCacheImage.bits();
+			QSemaphore Done;
+			int LinesPerBand = (Diameter + Bands - 1) / Bands;
+			for (int i = 1; i < Bands; ++i)
+			{
+				int FirstLine = i * LinesPerBand;
+				int LineCount = qMin(LinesPerBand, Diameter - FirstLine);
+				if (LineCount > 0)
+				{
+					bandThreadPool()->start(new QcBandRenderer(this,
+						Bits, mCacheImage, FirstLine, LineCount, &Done));
+				}
+				else
+				{
+					Done.release();
+				}
+			}
+			drawItemBand(this, Bits, mCacheImage, 0, LinesPerBand);
+			Done.acquire(Bands - 1);
+		}
+		else
+		{
+			QPainter Painter(&mCacheImage);
+			Painter.setRenderHints(QPainter::Antialiasing);
+			draw(&Painter);
+		}
+		mCacheRevision = mRevision;
 	}
+	painter->drawImage(QPointF(0, 0), mCacheImage);
 }
 
-
-bool QcNeedleItem::dropShadow() const
+bool QcItem::isDynamic() const
 {
-	return mDropShadow;
+	return false;
 }
 
 
-void QcNeedleItem::updateDropShadowImage()
+void QcItem::prepareDraw(QPaintDevice*)
 {
-	if (!mDropShadow)
-	{
-		return;
-	}
-
-    QRectF tmpRect = itemRect();
-	double Radius = getRadius(tmpRect);
-	QPolygonF NeedlePoly = createNeedlePoly(Radius);
-    QImage ShadowImage(NeedlePoly.boundingRect().size().toSize(), QImage::Format_ARGB32_Premultiplied);
-    ShadowImage.fill(Qt::transparent);
-    {
-    	QPainter Painter(&ShadowImage);
-		Painter.setRenderHint(QPainter::Antialiasing);
-		Painter.setBrush(mGaugeWidget->shadowBrush());
-		Painter.setPen(Qt::NoPen);
-		Painter.translate(NeedlePoly.boundingRect().width() / 2, - NeedlePoly.boundingRect().top());
-		Painter.drawConvexPolygon(NeedlePoly);
-    }
-    mDropShadowImage = mGaugeWidget->blurShadowImage(ShadowImage);
+	itemRect();
 }
 
 
-void QcNeedleItem::onWidgetSizeChanged(const QSize& Size)
+bool QcItem::supportsBandedDraw() const
 {
-	updateDropShadowImage();
+	return false;
 }
 
 
-void QcNeedleItem::setDecimals(int Decimals)
+double QcItem::position() const
 {
-	mDecimals = Decimals;
+    return mPosition;
 }
 
-
-int QcNeedleItem::decimals() const
+QRectF QcItem::widgetRect() const
 {
-	return mDecimals;
+    return mGaugeWidget->mGaugeRect;
 }
 
 
-void QcNeedleItem::setValue(double value)
+QRectF QcItem::itemRect() const
 {
-    if(value<mMinValue)
-        mCurrentValue = mMinValue;
-    else if(value>mMaxValue)
-        mCurrentValue = mMaxValue;
-    else
-        mCurrentValue = value;
-    if(mLabel!=0)
-        mLabel->setText(QString::number(mCurrentValue, 'f', mDecimals),false);
-    update();
+	if (mItemRectRevision != mGaugeWidget->mGeometryRevision)
+	{
+		mItemRect = adjustRect(position());
+		mItemRectRevision = mGaugeWidget->mGeometryRevision;
+	}
+	return mItemRect;
 }
 
-double QcNeedleItem::value() const
+
+void QcItem::setPosition(double position)
 {
-    return mCurrentValue;
+    if(position>100)
+        mPosition = 100;
+    else if(position<0)
+        mPosition = 0;
+    else
+        mPosition = position;
+    mItemRectRevision = 0;
+    invalidate();
 }
 
 
-void QcNeedleItem::setValueRange(double minValue,double maxValue)
+QRectF QcItem::adjustRect(double percentage) const
 {
-	QcScaleItem::setRange(minValue, maxValue);
+	QRectF Rect = widgetRect().adjusted(2, 2, -2, -2);
+    double r = getRadius(Rect);
+    double offset =   r - (percentage * r) / 100.0;
+    QRectF Result = Rect.adjusted(offset, offset, -offset, -offset);
+    return Result;
 }
 
-void QcNeedleItem::setMinimumValue(double minValue)
+double QcItem::getRadius(const QRectF &tmpRect)
 {
-	QcScaleItem::setMinimumValue(minValue);
+    double Diameter = qMin(tmpRect.width(), tmpRect.height());
+    return Diameter / 2.0;
 }
 
 
-void QcNeedleItem::setMaximumValue(double maxValue)
+QPointF QcItem::getPoint(double deg,const QRectF &tmpRect)
 {
-	QcScaleItem::setMaximumValue(maxValue);
+    double r = getRadius(tmpRect);
+    double xx=cos(qDegreesToRadians(deg))*r;
+    double yy=sin(qDegreesToRadians(deg))*r;
+    QPointF pt;
+    xx=tmpRect.center().x()-xx;
+    yy=tmpRect.center().y()-yy;
+    pt.setX(xx);
+    pt.setY(yy);
+    return pt;
 }
 
-void QcNeedleItem::setColor(const QColor &color)
-{
-    mBrush.setColor(color);
-    update();
-}
 
-const QColor& QcNeedleItem::color() const
+
+double QcItem::getAngle(const QPointF&pt, const QRectF &tmpRect)
 {
-    return mBrush.color();
+    double xx = tmpRect.center().x()-pt.x();
+    double yy = tmpRect.center().y()-pt.y();
+    return qRadiansToDegrees( atan2(yy,xx));
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
 
-void QcNeedleItem::setBrush(const QBrush& Brush)
+QcScaleItem::QcScaleItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mMinValue(0),
+    mMaxValue(100),
+    mMinDegree(-45),
+    mMaxDegree(225)
 {
-	mBrush = Brush;
+
 }
 
-const QBrush& QcNeedleItem::brush() const
+void QcScaleItem::setRange(double minValue, double maxValue)
 {
-	return mBrush;
+    if(!(minValue<maxValue))
+        throw( InvalidValueRange);
+    mMinValue = minValue;
+    mMaxValue = maxValue;
+    invalidate();
 }
 
-void QcNeedleItem::setLabel(QcLabelItem *label)
+void QcScaleItem::setDegreeRange(double minDegree, double maxDegree)
 {
-    mLabel = label;
-    mGaugeWidget->removeItem(label);
-    update();
+    if(!(minDegree<maxDegree))
+        throw( InvalidValueRange);
+    mMinDegree = minDegree;
+    mMaxDegree = maxDegree;
+    invalidate();
 }
 
-QcLabelItem *QcNeedleItem::label() const
+double QcScaleItem::getDegFromValue(double v) const
 {
-    return mLabel;
+    double a = (mMaxDegree-mMinDegree)/(mMaxValue-mMinValue);
+    double b = -a*mMinValue+mMinDegree;
+    return a*v+b;
 }
 
 
-void QcNeedleItem::setNeedle(QcNeedleItem::NeedleType needleType)
+void QcScaleItem::setMinimumValue(double minValue)
 {
-    mNeedleType = needleType;
-    if (CompassNeedle == needleType)
-    {
-    	QLinearGradient grad;
-    	grad.setCoordinateMode(QGradient::ObjectBoundingMode);
-    	grad.setFinalStop(QPointF(0, 1));
-    	grad.setColorAt(0.0,Qt::red);
-        grad.setColorAt(0.49,Qt::red);
-        grad.setColorAt(0.5,Qt::blue);
-        grad.setColorAt(1,Qt::blue);
-        mBrush = QBrush(grad);
-    }
-    update();
+    if(minValue>mMaxValue)
+        throw (InvalidValueRange);
+    mMinValue = minValue;
+    invalidate();
 }
 
 
-void QcNeedleItem::setCustomNeedle(const QVector<QPointF>& NeedlePoly)
+void QcScaleItem::setMaximumValue(double maxValue)
 {
-	mNeedleType = CustomNeedle;
-	mCustomNeedlePoly = NeedlePoly;
-    update();
+    if(maxValue<mMinValue )
+        throw (InvalidValueRange);
+    mMaxValue = maxValue;
+    invalidate();
 }
 
-
-void QcNeedleItem::setThicknessFactor(float Value)
+void QcScaleItem::setMinimumDegree(double minDegree)
 {
-	mThicknessFactor = Value;
+    if(minDegree>mMaxDegree)
+        throw (InvalidDegreeRange);
+    mMinDegree = minDegree;
+    invalidate();
+}
+void QcScaleItem::setMaximumDegree(double maxDegree)
+{
+    if(maxDegree<mMinDegree)
+        throw (InvalidDegreeRange);
+    mMaxDegree = maxDegree;
+    invalidate();
 }
 
 
-QPolygonF QcNeedleItem::createDiamonNeedle(double r) const
+double QcScaleItem::maximumDegree() const
 {
-    QVector<QPointF> tmpPoints;
-    tmpPoints.append(QPointF(0.0, 0.0));
-    tmpPoints.append(QPointF(-r/20.0 * mThicknessFactor, r/20.0));
-    tmpPoints.append(QPointF(0.0, r));
-    tmpPoints.append(QPointF(r/20.0 * mThicknessFactor, r/20.0));
-    return tmpPoints;
+	return mMaxDegree;
 }
 
-QPolygonF QcNeedleItem::createTriangleNeedle(double r) const
+
+double QcScaleItem::minimumDegree() const
 {
-    QVector<QPointF> tmpPoints;
-    tmpPoints.append(QPointF(0.0, r));
-    tmpPoints.append(QPointF(-r/40 * mThicknessFactor, 0.0));
-    tmpPoints.append(QPointF(r/40 * mThicknessFactor,0.0));
-    return tmpPoints;
+	return mMinDegree;
 }
 
-QPolygonF QcNeedleItem::createFeatherNeedle(double r) const
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Brush of the software rasterizers. Either a solid colour or a colour
+ * table of a linear gradient, indexed by the gradient position
+ * t = A * x + B * y + C of a pixel.
+ */
+struct QcSpanBrush
 {
-    QVector<QPointF> tmpPoints;
-    tmpPoints.append(QPointF(0.0, r));
-    tmpPoints.append(QPointF(-r/40.0 * mThicknessFactor, 0.0));
-    tmpPoints.append(QPointF(-r/15.0 * mThicknessFactor, -r/5.0));
-    tmpPoints.append(QPointF(r/15.0 * mThicknessFactor, -r/5));
-    tmpPoints.append(QPointF(r/40.0 * mThicknessFactor,0.0));
-    return tmpPoints;
-}
+	const uint* Table; ///< 256 premultiplied colours or 0 for a solid brush
+	uint Color; ///< premultiplied colour of a solid brush
+	double A;
+	double B;
+	double C;
+};
 
-QPolygonF QcNeedleItem::createAttitudeNeedle(double r) const
+
+/**
+ * Multiplies all channels of the premultiplied pixel x with a / 255
+ */
+static inline uint multiplyPixel(uint x, uint a)
 {
-    QVector<QPointF> tmpPoints;
-    tmpPoints.append(QPointF(0.0, r));
-    tmpPoints.append(QPointF(-r/20.0, 0.85*r));
-    tmpPoints.append(QPointF(r/20.0,0.85*r));
-    return tmpPoints;
+	uint t = (x & 0xff00ff) * a;
+	t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+	t &= 0xff00ff;
+	x = ((x >> 8) & 0xff00ff) * a;
+	x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+	x &= 0xff00ff00;
+	return x | t;
 }
 
-QPolygonF QcNeedleItem::createCompassNeedle(double r) const
+
+/**
+ * Blends the premultiplied colour Src with the coverage Coverage (0 - 255)
+ * over Dst
+ */
+static inline void blendPixel(uint& Dst, uint Src, uint Coverage)
 {
-    QVector<QPointF> tmpPoints;
-    tmpPoints.append(QPointF(0.0, r));
-    tmpPoints.append(QPointF(-r/15.0, 0.0));
-    tmpPoints.append(QPointF(0.0, -r));
-    tmpPoints.append(QPointF(r/15.0,0.0));
-    return tmpPoints;
+	if (Coverage < 255)
+	{
+		Src = multiplyPixel(Src, Coverage);
+	}
+	uint Alpha = Src >> 24;
+	Dst = (Alpha == 255) ? Src : Src + multiplyPixel(Dst, 255 - Alpha);
 }
 
 
-QPolygonF QcNeedleItem::createCustomNeedle(double r) const
+static inline uint spanColor(const QcSpanBrush& Brush, double x, double y)
 {
-	QVector<QPointF> tmpPoints(mCustomNeedlePoly);
-	for (int i = 0; i < tmpPoints.size(); ++i)
+	if (!Brush.Table)
 	{
-		tmpPoints[i] *= r;
+		return Brush.Color;
 	}
-
-	return tmpPoints;
+	int Index = int((Brush.A * x + Brush.B * y + Brush.C) * 255 + 0.5);
+	return Brush.Table[qBound(0, Index, 255)];
 }
 
 
-QPolygonF QcNeedleItem::createNeedlePoly(double Radius) const
+static QcSpanBrush solidSpanBrush(const QColor& Color)
 {
-    switch (mNeedleType)
-    {
-    case QcNeedleItem::FeatherNeedle: return createFeatherNeedle(Radius);
-    case QcNeedleItem::DiamonNeedle: return createDiamonNeedle(Radius);
-    case QcNeedleItem::TriangleNeedle: return createTriangleNeedle(Radius);
-    case QcNeedleItem::AltitudeMeterNeedle: return createAttitudeNeedle(Radius);
-    case QcNeedleItem::CompassNeedle: return createCompassNeedle(Radius);
-    case QcNeedleItem::CustomNeedle: return createCustomNeedle(Radius);
-    default:
-        return createTriangleNeedle(Radius);
-    }
+	QcSpanBrush Brush;
+	Brush.Table = 0;
+	Brush.Color = qPremultiply(Color.rgba());
+	Brush.A = Brush.B = Brush.C = 0;
+	return Brush;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
 
-QcValuesItem::QcValuesItem(QcGaugeWidget* ParentWidget) :
-    QcScaleItem(ParentWidget),
-    mStep(10),
-    mColor(Qt::black),
-    mScaleFactor(1),
-    mDecimals(1)
+/**
+ * Fills Table with 256 premultiplied colours of the gradient stops Stops.
+ * Like the QPainter gradients, the stops are premultiplied before they are
+ * interpolated, so a transparent stop does not tint its neighbour.
+ */
+static void gradientTable(const QGradientStops& Stops, uint* Table)
 {
-    setPosition(70);
+	int StopIndex = 0;
+	for (int i = 0; i < 256; ++i)
+	{
+		double t = i / 255.0;
+		while (StopIndex + 1 < Stops.size() && Stops.at(StopIndex + 1).first < t)
+		{
+			++StopIndex;
+		}
+		QRgb Color;
+		if (Stops.size() == 1 || t <= Stops.first().first)
+		{
+			Color = qPremultiply(Stops.first().second.rgba());
+		}
+		else if (StopIndex + 1 >= Stops.size())
+		{
+			Color = qPremultiply(Stops.last().second.rgba());
+		}
+		else
+		{
+			const QGradientStop& s0 = Stops.at(StopIndex);
+			const QGradientStop& s1 = Stops.at(StopIndex + 1);
+			double Range = s1.first - s0.first;
+			double f = (Range > 0) ? (t - s0.first) / Range : 1;
+			QRgb c0 = qPremultiply(s0.second.rgba());
+			QRgb c1 = qPremultiply(s1.second.rgba());
+			Color = qRgba(qRound(qRed(c0) + f * (qRed(c1) - qRed(c0))),
+				qRound(qGreen(c0) + f * (qGreen(c1) - qGreen(c0))),
+				qRound(qBlue(c0) + f * (qBlue(c1) - qBlue(c0))),
+				qRound(qAlpha(c0) + f * (qAlpha(c1) - qAlpha(c0))));
+		}
+		Table[i] = Color;
+	}
 }
 
 
-void QcValuesItem::draw(QPainter*painter)
+/**
+ * Returns the image the painter paints on, if the ring kernel can write
+ * directly into it. This is the case for the antialiased, unclipped,
+ * translated painters on the retained item images. Offset returns the
+ * translation of the painter.
+ */
+static QImage* kernelTarget(QPainter* Painter, QPointF* Offset)
 {
-    QRectF tmpRect = widgetRect();
-    double r = getRadius(adjustRect(99));
-    mFont.setPointSizeF(0.08 * r * mScaleFactor);
+	QPaintDevice* Device = Painter->device();
+	if (!Device || Device->devType() != QInternal::Image)
+	{
+		return 0;
+	}
 
-    painter->setFont(mFont);
-    painter->setPen(mColor);
-    for(double val = mMinValue;val<=mMaxValue;val+=mStep){
-        double deg = getDegFromValue(val);
-        QPointF pt = getPoint(deg,tmpRect);
-        QPainterPath path;
-        path.moveTo(pt);
-        path.lineTo(    tmpRect.center());
-        QString strVal = QString::number(val, 'f', mDecimals);
-        QFontMetrics fMetrics = painter->fontMetrics();
-        QSize sz = fMetrics.size( Qt::TextSingleLine, strVal );
-        QRectF txtRect(QPointF(0,0), sz );
-        QPointF textCenter = path.pointAtPercent(1.0-position()/100.0);
-        txtRect.moveCenter(textCenter);
+	QImage* Image = static_cast<QImage*>(Device);
+	if (Image->format() != QImage::Format_ARGB32_Premultiplied
+	 || Image->devicePixelRatio() != 1
+	 || Painter->transform().type() > QTransform::TxTranslate
+	 || Painter->compositionMode() != QPainter::CompositionMode_SourceOver
+	 || Painter->opacity() < 1
+	 || Painter->hasClipping()
+	 || !Painter->testRenderHint(QPainter::Antialiasing))
+	{
+		return 0;
+	}
 
-        painter->drawText( txtRect, Qt::TextSingleLine, strVal );
-    }
+	*Offset = QPointF(Painter->transform().dx(), Painter->transform().dy());
+	return Image;
 }
 
 
-void QcValuesItem::setDecimals(int Value)
+/**
+ * An annular sector, a full ring or a disc for the ring kernel.
+ * The angles are gauge angles: the direction of angle a is
+ * (-cos a, -sin a) in screen coordinates.
+ */
+struct QcRing
 {
-	mDecimals = Value;
-}
+	enum Wedge
+	{
+		FullRing,   ///< no angular limit
+		ConvexWedge,///< sweep <= 180 degree - inside both boundary rays
+		ConcaveWedge///< sweep > 180 degree - inside one of the boundary rays
+	};
+
+	double CenterX;
+	double CenterY;
+	double InnerRadius; ///< 0 for a disc
+	double OuterRadius;
+	Wedge Type;
+	double N0x; ///< inside normal of the start ray
+	double N0y;
+	double N1x; ///< inside normal of the end ray
+	double N1y;
+	QRectF Bounds; ///< bounding box of the sector
+};
+
+
+static QcRing ringSector(const QPointF& Center, double InnerRadius,
+	double OuterRadius, double StartDegree, double SweepDegree)
+{
+	if (SweepDegree < 0)
+	{
+		StartDegree += SweepDegree;
+		SweepDegree = -SweepDegree;
+	}
 
-void QcValuesItem::setStep(double step)
-{
-    mStep = step;
+	QcRing Ring;
+	Ring.CenterX = Center.x();
+	Ring.CenterY = Center.y();
+	Ring.InnerRadius = qMax(InnerRadius, 0.0);
+	Ring.OuterRadius = OuterRadius;
+	Ring.Type = (SweepDegree >= 360) ? QcRing::FullRing
+		: ((SweepDegree <= 180) ? QcRing::ConvexWedge : QcRing::ConcaveWedge);
+	// the derivative of the direction (-cos a, -sin a) is (sin a, -cos a),
+	// so this is the side of increasing angles of the start ray and the side
+	// of decreasing angles of the end ray
+	double a0 = qDegreesToRadians(StartDegree);
+	double a1 = qDegreesToRadians(StartDegree + SweepDegree);
+	Ring.N0x = sin(a0);
+	Ring.N0y = -cos(a0);
+	Ring.N1x = -sin(a1);
+	Ring.N1y = cos(a1);
+
+	// The bounding box of a sector contains the end points of both arcs and
+	// the points of the outer circle on the axes within the sweep
+	QRectF& Bounds = Ring.Bounds;
+	Bounds = QRectF(Center.x() - OuterRadius, Center.y() - OuterRadius,
+		2 * OuterRadius, 2 * OuterRadius);
+	if (Ring.Type != QcRing::FullRing)
+	{
+		const double Inf = std::numeric_limits<double>::max();
+		double MinX = Inf;
+		double MaxX = -Inf;
+		double MinY = Inf;
+		double MaxY = -Inf;
+		const double Radii[2] = {Ring.InnerRadius, OuterRadius};
+		const double Angles[2] = {a0, a1};
+		for (int i = 0; i < 4; ++i)
+		{
+			double x = Center.x() - Radii[i / 2] * cos(Angles[i % 2]);
+			double y = Center.y() - Radii[i / 2] * sin(Angles[i % 2]);
+			MinX = qMin(MinX, x);
+			MaxX = qMax(MaxX, x);
+			MinY = qMin(MinY, y);
+			MaxY = qMax(MaxY, y);
+		}
+		// the axis directions are at the gauge angles 0, 90, 180 and 270
+		for (int Axis = int(ceil(StartDegree / 90)); Axis * 90 <= StartDegree + SweepDegree; ++Axis)
+		{
+			switch (((Axis % 4) + 4) % 4)
+			{
+			case 0: MinX = Center.x() - OuterRadius; break;
+			case 1: MinY = Center.y() - OuterRadius; break;
+			case 2: MaxX = Center.x() + OuterRadius; break;
+			case 3: MaxY = Center.y() + OuterRadius; break;
+			}
+		}
+		Bounds = QRectF(QPointF(MinX, MinY), QPointF(MaxX, MaxY));
+	}
+	return Ring;
 }
 
 
-void QcValuesItem::setColor(const QColor& color)
+/**
+ * Fills one scan line of a ring. The signed distance of a pixel centre to
+ * the ring is the minimum of the radial distances to both circles and the
+ * distances to the boundary rays. The coverage is the distance clamped to
+ * [-0.5, 0.5]. Scan lines are independent of each other.
+ */
+static void fillRingRow(uint* Line, int Width, int y, const QcRing& Ring,
+	const QcSpanBrush& Brush)
 {
-    mColor = color;
-}
+	const double vy = y + 0.5 - Ring.CenterY;
+	const double Outer = Ring.OuterRadius + 0.5;
+	if (qAbs(vy) >= Outer)
+	{
+		return;
+	}
 
-void QcValuesItem::setFont(const QFont& font)
-{
-	mFont = font;
-	update();
-}
+	double HalfSpan = sqrt(Outer * Outer - vy * vy);
+	int x0 = qMax(0, int(floor(qMax(Ring.CenterX - HalfSpan, Ring.Bounds.left()) - 1)));
+	int x1 = qMin(Width - 1, int(ceil(qMin(Ring.CenterX + HalfSpan, Ring.Bounds.right()))));
 
+	// pixels inside the hole of the ring are skipped
+	int Hole0 = x1 + 1;
+	int Hole1 = x1;
+	const double Inner = Ring.InnerRadius - 0.5;
+	if (Inner > 0 && qAbs(vy) < Inner)
+	{
+		double HalfHole = sqrt(Inner * Inner - vy * vy);
+		Hole0 = int(ceil(Ring.CenterX - HalfHole - 0.5));
+		Hole1 = int(floor(Ring.CenterX + HalfHole - 0.5));
+	}
 
-const QFont& QcValuesItem::font() const
-{
-	return mFont;
+	for (int x = x0; x <= x1; ++x)
+	{
+		if (x >= Hole0 && x <= Hole1)
+		{
+			x = Hole1;
+			continue;
+		}
+
+		const double vx = x + 0.5 - Ring.CenterX;
+		const double d = sqrt(vx * vx + vy * vy);
+		double Distance = Ring.OuterRadius - d;
+		if (Ring.InnerRadius > 0)
+		{
+			Distance = qMin(Distance, d - Ring.InnerRadius);
+		}
+		if (Ring.Type != QcRing::FullRing)
+		{
+			double h0 = Ring.N0x * vx + Ring.N0y * vy;
+			double h1 = Ring.N1x * vx + Ring.N1y * vy;
+			Distance = qMin(Distance, (Ring.Type == QcRing::ConvexWedge)
+				? qMin(h0, h1) : qMax(h0, h1));
+		}
+		if (Distance <= -0.5)
+		{
+			continue;
+		}
+
+		int Coverage = (Distance >= 0.5) ? 255 : int((Distance + 0.5) * 255 + 0.5);
+		blendPixel(Line[x], spanColor(Brush, x + 0.5, y + 0.5), Coverage);
+	}
 }
 
-void QcValuesItem::setScaleFactor(float ScaleFactor)
+
+/**
+ * Fills a ring into the ARGB32_Premultiplied image Image. Only the pixels
+ * in the bounding box of the sector are visited.
+ */
+static void fillRing(QImage& Image, const QcRing& Ring, const QcSpanBrush& Brush)
 {
-	mScaleFactor = ScaleFactor;
+	int FirstY = qMax(0, int(floor(Ring.Bounds.top())) - 1);
+	int LastY = qMin(Image.height() - 1, int(ceil(Ring.Bounds.bottom())) + 1);
+	uchar* Bits = Image.bits();
+	const int BytesPerLine = Image.bytesPerLine();
+	for (int y = FirstY; y <= LastY; ++y)
+	{
+		fillRingRow(reinterpret_cast<uint*>(Bits + y * BytesPerLine),
+			Image.width(), y, Ring, Brush);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-QcAltitudeMeter::QcAltitudeMeter(QcGaugeWidget* ParentWidget) :
+QcBackgroundItem::QcBackgroundItem(QcGaugeWidget* ParentWidget) :
     QcItem(ParentWidget),
-    mRoll(0),
-    mPitch(0)
+    mBrush(Qt::darkGray),
+    mDropShadowDiameter(0),
+    mDropShadow(false)
 {
+    mPosition = 88;
+    mPen = Qt::NoPen;
 
+    addColor(0.4,Qt::darkGray);
+    addColor(0.8,Qt::black);
 }
 
-void QcAltitudeMeter::setCurrentPitch(double pitch)
-{
-    mPitch=-pitch;
-    update();
-}
-
-void QcAltitudeMeter::setCurrentRoll(double roll)
-{
-    mRoll = roll;
-    update();
-}
 
-QPointF QcAltitudeMeter::intersection(double r, const QPointF &pitchPoint, const QPointF &pt) const
+QcBackgroundItem::~QcBackgroundItem()
 {
-    // refrence it to zero
 
-    Q_UNUSED(r)
-    double a = (pitchPoint.y()-pt.y())/(pitchPoint.x()-pt.x());
-    double b = pt.y()-a*pt.x();
-    return QPointF(0,a*0+b);
 }
 
-double QcAltitudeMeter::startAngle(const QRectF& tmpRect) const
+
+void QcBackgroundItem::draw(QPainter* painter)
 {
-    double r = getRadius(tmpRect);
-    QPointF pt1 = getPoint(mRoll,tmpRect);
-    pt1.setY(pt1.y()-mPitchOffset);
-    QPointF pitchPoint = QPointF(tmpRect.center().x(),tmpRect.center().y()-mPitchOffset);
+    QRectF tmpRect = widgetRect();
 
+    if (mDropShadow)
+    {
+		// the shadow is created lazily and recreated if the size changed
+		if (mDropShadowImage.isNull() || mDropShadowDiameter != mGaugeWidget->diameter())
+		{
+			updateDropShadowImage();
+		}
+		QPointF ShadowOffset = mGaugeWidget->shadowOffset();
+		painter->save();
+		painter->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+		painter->translate(-(mDropShadowImage.width() / 2.0) + ShadowOffset.x(),
+			-(mDropShadowImage.height() / 2.0) +  ShadowOffset.y());
+		painter->drawImage(itemRect().center(), mDropShadowImage);
+		painter->restore();
+    }
 
-    ///////////////////////////////////////
-    QPainterPath path1;
-    path1.moveTo(pitchPoint);
-    path1.lineTo(intersection(r,pitchPoint,pt1)+QPointF(0,5));
-    path1.lineTo(intersection(r,pitchPoint,pt1)+QPointF(0,-5));
+    QLinearGradient linearGrad(tmpRect.topLeft(), tmpRect.bottomRight());
+    for(int i = 0;i<mColors.size();i++){
+    	linearGrad.setColorAt(mColors[i].first,mColors[i].second);
+    }
 
-    QPainterPath path2;
-    path2.addEllipse(tmpRect);
+    // Without outline the background is a disc that is filled by the ring
+    // kernel directly into the retained image
+    QPointF Offset;
+    QImage* Target = kernelTarget(painter, &Offset);
+    if (Target && mPen.style() == Qt::NoPen
+     && (!mColors.empty() || mBrush.style() == Qt::SolidPattern))
+    {
+    	QRectF Rect = itemRect();
+    	QcSpanBrush Brush = solidSpanBrush(mBrush.color());
+    	uint Table[256];
+    	if (!mColors.empty())
+    	{
+    		gradientTable(linearGrad.stops(), Table);
+    		QPointF Start = linearGrad.start() + Offset;
+    		QPointF Delta = linearGrad.finalStop() - linearGrad.start();
+    		double Length2 = Delta.x() * Delta.x() + Delta.y() * Delta.y();
+    		if (Length2 > 0)
+    		{
+    			Brush.A = Delta.x() / Length2;
+    			Brush.B = Delta.y() / Length2;
+    			Brush.C = -(Start.x() * Delta.x() + Start.y() * Delta.y()) / Length2;
+    		}
+    		Brush.Table = Table;
+    	}
+    	fillRing(*Target, ringSector(Rect.center() + Offset, 0, Rect.width() / 2.0,
+    		0, 360), Brush);
+    	return;
+    }
 
-    QPointF p = path1.intersected(path2).pointAtPercent(.5);
-    return getAngle(p,tmpRect);
+    if (!mColors.empty())
+    {
+		painter->setBrush(linearGrad);
+    }
+    else
+    {
+    	painter->setBrush(mBrush);
+    }
+
+    painter->setPen(mPen);
+    painter->drawEllipse(itemRect());
 }
 
-void QcAltitudeMeter::draw(QPainter *painter)
+void QcBackgroundItem::prepareDraw(QPaintDevice* Device)
 {
-    QRectF tmpRect = itemRect();
-    double r = getRadius(tmpRect);
-    if(mPitch<0)
-        mPitchOffset = 0.0135*r*mPitch;
-    else
-        mPitchOffset = 0.015*r*mPitch;
+	QcItem::prepareDraw(Device);
+	if (mDropShadow
+	 && (mDropShadowImage.isNull() || mDropShadowDiameter != mGaugeWidget->diameter()))
+	{
+		updateDropShadowImage();
+	}
+}
 
-    painter->setPen(Qt::NoPen);
-    drawUpperEllipse(painter,tmpRect);
-    drawLowerEllipse(painter,tmpRect);
 
-    // Steps
+bool QcBackgroundItem::supportsBandedDraw() const
+{
+	return true;
+}
 
-    drawPitchSteps(painter,tmpRect);
-    drawHandle(painter);
+void QcBackgroundItem::addColor(double position, const QColor &color)
+{
+    if(position<0||position>1)
+        return;
+      QPair<double,QColor> pair;
+      pair.first = position;
+      pair.second = color;
+      mColors.append(pair);
+      invalidate();
+}
 
-    drawDegrees(painter);
+void QcBackgroundItem::clearColors()
+{
+    mColors.clear();
+    invalidate();
 }
 
-void QcAltitudeMeter::drawDegrees(QPainter *painter)
+
+void QcBackgroundItem::setDropShadow(bool DropShadow)
 {
-    QRectF tmpRect = itemRect();
-    double r = getRadius(tmpRect);
-    QPen pen;
+	mDropShadow = DropShadow;
+	mDropShadowImage = QImage();
+	invalidate();
+}
 
-    pen.setColor(Qt::white);
-    painter->setPen(pen);
-    for(int deg = 60;deg<=120;deg+=10){
-        if(deg == 90)
-            continue;
-        drawDegree(painter,tmpRect,deg);
-    }
 
-    pen.setWidthF(r/30.0);
-    painter->setPen(pen);
-    drawDegree(painter,tmpRect,0);
-    drawDegree(painter,tmpRect,90);
-    drawDegree(painter,tmpRect,180);
-    drawDegree(painter,tmpRect,30);
-    drawDegree(painter,tmpRect,150);
+bool QcBackgroundItem::dropShadow() const
+{
+	return mDropShadow;
 }
 
 
-void QcAltitudeMeter::drawDegree(QPainter * painter, const QRectF& tmpRect,double deg)
+void QcBackgroundItem::releaseCache()
 {
-    QPointF pt1 = getPoint(deg,tmpRect);
-    QPointF pt2 = tmpRect.center();
-    QPainterPath path;
-    path.moveTo(pt1);
-    path.lineTo(pt2);
-    QPointF pt = path.pointAtPercent(0.1);
-    painter->drawLine(pt1,pt);
+	QcItem::releaseCache();
+	mDropShadowImage = QImage();
 }
 
 
-void QcAltitudeMeter::drawUpperEllipse(QPainter *painter, const QRectF &tmpRect)
+qint64 QcBackgroundItem::cacheSize() const
 {
+	return QcItem::cacheSize() + imageBytes(mDropShadowImage);
+}
 
-    QLinearGradient radialGrad1(tmpRect.topLeft(),tmpRect.bottomRight());
-    QColor clr1 = Qt::blue;
-    clr1.setAlphaF(0.5);
-    QColor clr2 = Qt::darkBlue;
-    clr2.setAlphaF(0.5);
-    radialGrad1.setColorAt(0, clr1);
-    radialGrad1.setColorAt(.8, clr2);
 
+void QcBackgroundItem::updateDropShadowImage()
+{
+	if (!mDropShadow)
+	{
+		return;
+	}
 
-    double offset = startAngle(tmpRect);
-    double startAngle = 180-offset;
-    double endAngle = offset-2*mRoll;
-    double span =endAngle-startAngle;
+	QRectF tmpRect = itemRect();
+	tmpRect.moveTopLeft(QPointF(0, 0));
+	QImage ShadowImage(tmpRect.size().toSize(), QImage::Format_ARGB32_Premultiplied);
+    ShadowImage.fill(Qt::transparent);
+    {
+    	QPainter Painter(&ShadowImage);
+		Painter.setRenderHint(QPainter::Antialiasing);
+		Painter.setBrush(QColor(0, 0, 0, 160));
+		Painter.setPen(Qt::NoPen);
+		Painter.drawEllipse(tmpRect);
+    }
+    mDropShadowImage = compactShadowImage(mGaugeWidget->blurShadowImage(ShadowImage),
+    	mGaugeWidget->shadowBrush());
+    mDropShadowDiameter = mGaugeWidget->diameter();
+}
 
-    painter->setBrush(radialGrad1);
-    painter->drawChord(tmpRect,16*startAngle,16*span);
 
+void QcBackgroundItem::setBrush(const QBrush& Brush)
+{
+	mBrush = Brush;
+	invalidate();
 }
 
+const QBrush& QcBackgroundItem::brush() const
+{
+	return mBrush;
+}
 
-void QcAltitudeMeter::drawLowerEllipse(QPainter *painter, const QRectF &tmpRect)
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcGlassItem::QcGlassItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mGlassType(CurvedGlass2)
 {
-    QLinearGradient radialGrad2(tmpRect.topLeft(),tmpRect.bottomRight());
-    QColor clr1 = QColor(139,119,118);
-    QColor clr2 = QColor(139,119,101);
-    radialGrad2.setColorAt(0, clr1);
-    radialGrad2.setColorAt(.8, clr2);
+    mPosition = 88;
+}
 
-    double offset = startAngle(tmpRect);
-    double startAngle = 180+offset;
-    double endAngle = offset-2*mRoll;
-    double span =endAngle+startAngle;
+void QcGlassItem::draw(QPainter *painter)
+{
+    QColor clr1(Qt::white);
+    QLinearGradient linearGrad1;
+    linearGrad1.setCoordinateMode(QGradient::ObjectBoundingMode);
+    linearGrad1.setStart(0,0);
+    linearGrad1.setFinalStop(0,1);
+    clr1.setAlphaF(0.7);
+    linearGrad1.setColorAt(0, clr1);
+    clr1.setAlphaF(0.35);
+    linearGrad1.setColorAt(0.4, clr1);
+    clr1.setAlphaF(0.15);
+    linearGrad1.setColorAt(1, clr1);
 
+	QPainterPath Path;
+	QBrush Brush(linearGrad1);
+	switch (mGlassType)
+	{
+		case StronglyCurvedGlass: createStronglyCurvedGlass(Path, Brush); break;
+		case CurvedGlass1: createCurvedGlass1(Path, Brush); break;
+		case CurvedGlass2: createCurvedGlass2(Path, Brush); break;
+		case FlatGlass: createFlatGlass(Path, Brush); break;
+		case FlatGlass2: createFlatGlass2(Path, Brush); break;
+		default:
+			createStronglyCurvedGlass(Path, Brush); break;
+	}
+    painter->setBrush(Brush);
     painter->setPen(Qt::NoPen);
-    painter->setBrush(radialGrad2);
-    painter->drawChord(tmpRect,-16*startAngle,16*span);
+    painter->drawPath(Path);
+}
+
 
+void QcGlassItem::setGlassType(GlassType glassType)
+{
+	mGlassType = glassType;
+	invalidate();
 }
 
-void QcAltitudeMeter::drawPitchSteps(QPainter *painter, const QRectF &tmpRect)
+
+bool QcGlassItem::supportsBandedDraw() const
 {
-    double r = getRadius(tmpRect);
-    QPointF center = tmpRect.center();
-    painter->save();
-    painter->translate(center.x(),center.y()-mPitchOffset);
-    painter->rotate(mRoll);
-    QPen pen;
-    pen.setColor(Qt::white);
-    pen.setWidthF(r/40.0);
+	return true;
+}
 
-    painter->setPen(pen);
-    for (int i = -30;i<=30;i+=10){
-        QPointF pt1;
-        pt1.setX(-0.01*r*abs(i));
-        pt1.setY(r/70.0*i);
-        QPointF pt2;
-        pt2.setX(0.01*r*abs(i));
-        pt2.setY(r/70.0*i);
-        painter->drawLine(pt1,pt2);
 
-        if(i==0)
-            continue;
+void QcGlassItem::createStronglyCurvedGlass(QPainterPath& Path,
+	QBrush& Brush)
+{
+    static const double Angle = 2;
 
-        // draw value
-        QFont font("Meiryo UI",0, QFont::Bold);
-        font.setPointSizeF(0.08*r);
-        painter->setFont(font);
-        QString strVal = QString::number(abs(i));
-        QFontMetrics fMetrics = painter->fontMetrics();
-        QSize sz = fMetrics.size( Qt::TextSingleLine, strVal );
-        QRectF leftTxtRect(QPointF(0,0), sz );
-        QRectF rightTxtRect(QPointF(0,0), sz );
-        leftTxtRect.moveCenter(pt1-QPointF(0.1*r,0));
-        rightTxtRect.moveCenter(pt2+QPointF(0.1*r,0));
-        painter->drawText( leftTxtRect, Qt::TextSingleLine, strVal );
-        painter->drawText( rightTxtRect, Qt::TextSingleLine, strVal );
+	QRectF tmpRect1 = itemRect();
+    QPointF Start = getPoint(Angle, tmpRect1);
+    QPointF End = getPoint(180 - Angle, tmpRect1);
+    Path.moveTo(End);
+    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
+	QRectF tmpRect2;
+	tmpRect2.setWidth(qAbs(End.x() - Start.x()));
+	tmpRect2.setHeight(tmpRect1.height() / 5);
+	tmpRect2.moveCenter(QPointF(tmpRect1.center().x(), Start.y()));
+	Path.arcTo(tmpRect2, 180, 180);
+}
+
+
+void QcGlassItem::createCurvedGlass1(QPainterPath& Path,
+	QBrush& Brush)
+{
+    static const double Angle = 0;
+
+	QRectF tmpRect1 = itemRect();
+    QPointF Start = getPoint(Angle, tmpRect1);
+    QPointF End = getPoint(180 - Angle, tmpRect1);
+    Path.moveTo(End);
+    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
+    Path.quadTo(QPointF(tmpRect1.center().x(), Start.y() + tmpRect1.height() / 7), End);
+}
+
+
+void QcGlassItem::createCurvedGlass2(QPainterPath& Path,
+	QBrush& Brush)
+{
+    static const double Angle = 5;
+
+	QRectF tmpRect1 = itemRect();
+    QPointF Start = getPoint(Angle, tmpRect1);
+    QPointF End = getPoint(180 - Angle, tmpRect1);
+    Path.moveTo(End);
+    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
+    Path.quadTo(QPointF(tmpRect1.center().x(), Start.y() - tmpRect1.height() / 7), End);
+}
+
+
+void QcGlassItem::createFlatGlass(QPainterPath& Path,
+	QBrush& Brush)
+{
+	QRectF tmpRect1 = itemRect();
+    QColor clr1 = Qt::white;
+    QColor clr2 = Qt::white;
+    clr1.setAlphaF(0.6);
+    clr2.setAlphaF(0.1);
+
+    QLinearGradient linearGrad1(QPointF(0, tmpRect1.top()), QPointF(0, tmpRect1.bottom()));
+    linearGrad1.setColorAt(0, clr1);
+    linearGrad1.setColorAt(1, clr2);
+    Brush = QBrush(linearGrad1);
+
+    QPointF End = getPoint(100, tmpRect1);
+    Path.moveTo(End);
+    Path.arcTo(tmpRect1, 80, 160);
+}
+
+
+void QcGlassItem::createFlatGlass2(QPainterPath& Path, QBrush& Brush)
+{
+    static const double Angle = 10;
+    QRectF tmpRect1 = itemRect();
+
+    QColor clr1(Qt::white);
+    QLinearGradient linearGrad1;
+    linearGrad1.setCoordinateMode(QGradient::ObjectBoundingMode);
+    linearGrad1.setStart(0,0);
+    linearGrad1.setFinalStop(0, 0.7);
+    clr1.setAlphaF(0.7);
+    linearGrad1.setColorAt(0, clr1);
+    clr1.setAlphaF(0.3);
+    linearGrad1.setColorAt(0.4, clr1);
+    clr1.setAlphaF(0.2);
+    linearGrad1.setColorAt(1, clr1);
+    Brush = QBrush(linearGrad1);
+
+    QPointF Start = getPoint(Angle, tmpRect1);
+    QPointF End = getPoint(180 - Angle, tmpRect1);
+    Path.moveTo(End);
+    Path.arcTo(tmpRect1, Angle, 180 - 2 * Angle);
+    Path.cubicTo(QPointF(tmpRect1.center().x(), tmpRect1.center().y() + tmpRect1.height() / 12 ),
+    	QPointF(tmpRect1.center().x() + tmpRect1.width() / 8, End.y() - tmpRect1.height() / 4),
+    	QPointF(End.x(), Start.y()));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcLabelItem::QcLabelItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mAngle(270),
+    mText("%"),
+    mColor(Qt::black),
+    mPen(mColor),
+    mScaleFactor(1),
+    mFontRadius(-1)
+{
+    mPosition = 50;
+}
+
+void QcLabelItem::draw(QPainter *painter)
+{
+    QRectF tmpRect = itemRect();
+    updateFont();
+    painter->setFont(mFont);
+    painter->setPen(mPen);
+
+    // the text is centered on an empty rect, so its size is not measured
+    // with a QFontMetrics, which lays out and allocates for each new text
+    QPointF txtCenter = getPoint(mAngle,tmpRect);
+    QRectF txtRect(txtCenter, QSizeF(0, 0));
+
+    painter->drawText( txtRect, Qt::AlignCenter | Qt::TextSingleLine
+        | Qt::TextDontClip, mText);
+
+}
+
+void QcLabelItem::updateFont()
+{
+    double r = getRadius(widgetRect());
+    if (r != mFontRadius)
+    {
+    	// modifying the font while the painter shares it would detach it, so
+    	// the font is only scaled if the size changed
+    	mFont.setPointSizeF(r / 10.0 * mScaleFactor);
+    	mFontRadius = r;
     }
-    painter->restore();
 }
 
-void QcAltitudeMeter::drawHandle(QPainter *painter)
+
+void QcLabelItem::prepareDraw(QPaintDevice* Device)
 {
-    QRectF tmpRct = adjustRect(15);
-    double r = getRadius(tmpRct);
+	QcItem::prepareDraw(Device);
+	updateFont();
+}
+
+
+void QcLabelItem::setAngle(double a)
+{
+    mAngle = a;
+    invalidate();
+}
+
+double QcLabelItem::angle() const
+{
+    return mAngle;
+}
+
+void QcLabelItem::setText(const QString &text, bool repaint)
+{
+    mText = text;
+    if(repaint)
+        invalidate();
+}
+
+
+void QcLabelItem::setValueText(double Value, int Decimals, bool repaint)
+{
+	char Buffer[64];
+	int Length = qsnprintf(Buffer, sizeof(Buffer), "%.*f", Decimals, Value);
+	Length = qBound(0, Length, int(sizeof(Buffer)) - 1);
+
+	// resize() only allocates if the text is shared or exceeds its capacity
+	mText.resize(Length);
+	QChar* Text = mText.data();
+	for (int i = 0; i < Length; ++i)
+	{
+		Text[i] = QLatin1Char(Buffer[i]);
+	}
+	if (repaint)
+	{
+		invalidate();
+	}
+}
+
+const QString& QcLabelItem::text() const
+{
+    return mText;
+}
+
+void QcLabelItem::setColor(const QColor &color)
+{
+    mColor = color;
+    mPen = QPen(mColor);
+    invalidate();
+}
+
+const QColor& QcLabelItem::color() const
+{
+    return mColor;
+}
+
+void QcLabelItem::setFont(const QFont& font)
+{
+	mFont = font;
+	mFontRadius = -1;
+	invalidate();
+}
+
+
+const QFont& QcLabelItem::font() const
+{
+	return mFont;
+}
+
+
+void QcLabelItem::setScaleFactor(float Factor)
+{
+	mScaleFactor = Factor;
+	mFontRadius = -1;
+	invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcArcItem::QcArcItem(QcGaugeWidget* ParentWidget) :
+    QcScaleItem(ParentWidget),
+    mColor(Qt::black)
+{
+    mPosition = 80;
+}
+
+void QcArcItem::draw(QPainter *painter)
+{
+    QRectF tmpRect= itemRect();
+    double r = getRadius(tmpRect);
+
+    double PenWidth = qMax(r/40.0, 1.0);
+
+    QPointF Offset;
+    QImage* Target = kernelTarget(painter, &Offset);
+    if (Target)
+    {
+    	// the square caps of the pen extend the arc by half the pen width
+    	double Extension = qRadiansToDegrees(PenWidth / 2.0 / r);
+    	fillRing(*Target, ringSector(tmpRect.center() + Offset, r - PenWidth / 2.0,
+    		r + PenWidth / 2.0, qMin(mMinDegree, mMaxDegree) - Extension,
+    		qAbs(mMaxDegree - mMinDegree) + 2 * Extension), solidSpanBrush(mColor));
+    	return;
+    }
+
     QPen pen;
-    pen.setColor(Qt::gray);
-    pen.setWidthF(0.25*r);
+    pen.setColor(mColor);
+    pen.setWidthF(PenWidth);
     painter->setPen(pen);
-    painter->drawArc(tmpRct,0,-16*180);
+    painter->drawArc(tmpRect,-16*(mMinDegree+180),-16*(mMaxDegree-mMinDegree));
+}
 
-    QPointF center = tmpRct.center();
-    QPointF leftPt1 = center;
-    QPointF leftPt2 = center;
-    QPointF rightPt1 = center;
-    QPointF rightPt2 = center;
-    leftPt1.setX(center.x()-2*r);
-    leftPt2.setX(center.x()-r);
-    rightPt1.setX(center.x()+2*r);
-    rightPt2.setX(center.x()+r);
-    painter->drawLine(leftPt1,leftPt2);
-    painter->drawLine(rightPt1,rightPt2);
-    painter->drawEllipse(adjustRect(2));
+bool QcArcItem::supportsBandedDraw() const
+{
+	return true;
+}
 
-    //
-    QPointF pt1 = center;
-    QPointF pt2 = center;
-    // to get the real 100 % radius, without recomputing
-    pt1.setY(center.y()+r);
-    pt2.setY(center.y()+4*r);
-    pen.setColor(Qt::gray);
-    painter->setPen(pen);
-    painter->drawLine(pt1,pt2);
+void QcArcItem::setColor(const QColor &color)
+{
+    mColor = color;
+    invalidate();
+}
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
 
-    // trapezium
-    painter->setPen(Qt::gray);
-    painter->setBrush(Qt::gray);
-    QPolygonF trapPoly;
-    QPointF tmpPt = center;
-    tmpPt.setX(center.x()-r);
-    tmpPt.setY(center.y()+4*r);
-    trapPoly.append(tmpPt);
-    tmpRct = itemRect();
-    trapPoly.append(getPoint(290,tmpRct));
-    trapPoly.append(getPoint(250,tmpRct));
-    tmpPt = center;
+/**
+ * Alarm evaluation state of a color band
+ */
+class QcAlarmState
+{
+public:
+	QcAlarmState() :
+		AlarmZones(0),
+		Hysteresis(0),
+		OnDelay(0),
+		Flash(false),
+		Zone(-1),
+		PendingZone(-1),
+		PendingSince(0),
+		StayLow(std::numeric_limits<double>::max()),
+		StayHigh(-std::numeric_limits<double>::max()),
+		Events(64),
+		EventHead(0),
+		EventCount(0),
+		OverlayZone(-1),
+		OverlayRevision(0)
+	{
+		Clock.start();
+	}
+
+	bool isAlarm(int ZoneIndex) const
+	{
+		return ZoneIndex >= 0 && ZoneIndex < 64 && (AlarmZones & (Q_UINT64_C(1) << ZoneIndex));
+	}
+
+	quint64 AlarmZones; ///< bit mask of the zones that raise an alarm
+	double Hysteresis;
+	int OnDelay; ///< ms
+	bool Flash;
+	QVector<double> Limits; ///< upper limit of each zone
+	int Zone; ///< committed zone or -1
+	int PendingZone; ///< zone the values moved into
+	qint64 PendingSince; ///< time the values moved into PendingZone
+	double StayLow; ///< values from StayLow to StayHigh stay in Zone
+	double StayHigh;
+	QVector<QcAlarmEvent> Events; ///< ring buffer of transitions
+	int EventHead; ///< index of the oldest event
+	int EventCount;
+	QElapsedTimer Clock;
+	QPen OverlayPen;
+	QPainterPath OverlayPath; ///< sub band of OverlayZone
+	int OverlayZone;
+	quint64 OverlayRevision; ///< item revision of OverlayPath
+	QRectF OverlayRect; ///< item rect of OverlayPath
+	QVector<QcNeedleItem*> Needles; ///< needles that use the band for alarms
+};
+
+
+QcColorBand::QcColorBand(QcGaugeWidget* ParentWidget) :
+    QcScaleItem(ParentWidget),
+    mBandStartValue(0),
+    mPenWidthScaleFactor(1),
+    mAlarm(0)
+{
+    QColor tmpColor;
+    tmpColor.setAlphaF(0.1);
+    QPair<QColor,double> pair;
+
+    pair.first = Qt::green;
+    pair.second = 10;
+    mBandColors.append(pair);
+
+    pair.first = Qt::darkGreen;
+    pair.second = 50;
+    mBandColors.append(pair);
+
+    pair.first = Qt::red;
+    pair.second = 100;
+    mBandColors.append(pair);
+
+    mPosition = 50;
+}
+
+QPainterPath QcColorBand::createSubBand(double from, double sweep)
+{
+    QRectF tmpRect = itemRect();
+    QPainterPath path;
+    path.arcMoveTo(tmpRect,180+from);
+    path.arcTo(tmpRect,180+from,-sweep);
+    return path;
+}
+
+void QcColorBand::draw(QPainter *painter)
+{
+    double r = getRadius(widgetRect());
+    QPen pen;
+    pen.setCapStyle(Qt::FlatCap);
+    pen.setWidthF(r/20.0 * mPenWidthScaleFactor);
+    painter->setBrush(Qt::NoBrush);
+    double offset = getDegFromValue(mBandStartValue);
+
+    // the sub bands are annular sectors that are filled by the ring kernel
+    // directly into the retained image instead of stroking arc paths
+    QPointF Offset;
+    QImage* Target = kernelTarget(painter, &Offset);
+    QRectF tmpRect = itemRect();
+    double Radius = getRadius(tmpRect);
+    double HalfWidth = pen.widthF() / 2.0;
+    for(int i = 0;i<mBandColors.size();i++){
+        QColor clr = mBandColors[i].first;
+        double sweep;
+        if(i==0)
+            sweep = getDegFromValue(mBandColors[i].second)-getDegFromValue(mMinValue);
+        else
+            sweep = getDegFromValue(mBandColors[i].second)-getDegFromValue(mBandColors[i-1].second);
+        if (Target)
+        {
+        	if (sweep != 0)
+        	{
+        		fillRing(*Target, ringSector(tmpRect.center() + Offset, Radius - HalfWidth,
+        			Radius + HalfWidth, offset, sweep), solidSpanBrush(clr));
+        	}
+        	offset += sweep;
+        	continue;
+        }
+        QPainterPath path = createSubBand(-offset,sweep);
+        offset += sweep;
+        pen.setColor(clr);
+        painter->setPen(pen);
+        painter->drawPath(path);
+    }
+}
+
+bool QcColorBand::supportsBandedDraw() const
+{
+	return true;
+}
+
+QcColorBand::~QcColorBand()
+{
+	if (mAlarm)
+	{
+		// the needles must not evaluate their values against a deleted band
+		for (int i = 0; i < mAlarm->Needles.size(); ++i)
+		{
+			mAlarm->Needles.at(i)->mAlarmBand = 0;
+		}
+		mGaugeWidget->setAlarmFlashing(this, false);
+		delete mAlarm;
+	}
+}
+
+void QcColorBand::setColors(const QList<QPair<QColor, double> > &colors)
+{
+    mBandColors = colors;
+    updateZoneLimits();
+    invalidate();
+}
+
+void QcColorBand::setPenWidthScaleFactor(float Factor)
+{
+	mPenWidthScaleFactor = Factor;
+	invalidate();
+}
+
+
+/**
+ * Returns the alarm state and creates it on the first call
+ */
+QcAlarmState* QcColorBand::alarm()
+{
+	if (!mAlarm)
+	{
+		mAlarm = new QcAlarmState();
+		updateZoneLimits();
+	}
+	return mAlarm;
+}
+
+
+/**
+ * Copies the zone limits into a flat array for the evaluation and restarts
+ * the evaluation
+ */
+void QcColorBand::updateZoneLimits()
+{
+	if (!mAlarm)
+	{
+		return;
+	}
+	mAlarm->Limits.resize(mBandColors.size());
+	for (int i = 0; i < mBandColors.size(); ++i)
+	{
+		mAlarm->Limits[i] = mBandColors.at(i).second;
+	}
+	mAlarm->Zone = -1;
+	mAlarm->PendingZone = -1;
+	mAlarm->StayLow = std::numeric_limits<double>::max();
+	mAlarm->StayHigh = -std::numeric_limits<double>::max();
+	mAlarm->OverlayZone = -1;
+	mGaugeWidget->setAlarmFlashing(this, false);
+}
+
+
+void QcColorBand::setAlarmZones(quint64 AlarmZones)
+{
+	alarm()->AlarmZones = AlarmZones;
+	mGaugeWidget->setAlarmFlashing(this, mAlarm->Flash && mAlarm->isAlarm(mAlarm->Zone));
+}
+
+
+void QcColorBand::setAlarmHysteresis(double Hysteresis)
+{
+	alarm()->Hysteresis = qAbs(Hysteresis);
+	int Zone = mAlarm->Zone;
+	updateZoneLimits();
+	if (Zone >= 0 && Zone < mAlarm->Limits.size())
+	{
+		// keep the committed zone, only its stay range changes
+		mAlarm->Zone = Zone;
+		mAlarm->PendingZone = Zone;
+		double Low = (Zone == 0) ? -std::numeric_limits<double>::max()
+			: mAlarm->Limits.at(Zone - 1) - mAlarm->Hysteresis;
+		double High = (Zone == mAlarm->Limits.size() - 1)
+			? std::numeric_limits<double>::max()
+			: mAlarm->Limits.at(Zone) + mAlarm->Hysteresis;
+		mAlarm->StayLow = Low;
+		mAlarm->StayHigh = High;
+		mGaugeWidget->setAlarmFlashing(this, mAlarm->Flash && mAlarm->isAlarm(Zone));
+	}
+}
+
+
+void QcColorBand::setAlarmOnDelay(int Msecs)
+{
+	alarm()->OnDelay = qMax(Msecs, 0);
+}
+
+
+void QcColorBand::setAlarmFlashing(bool Flash)
+{
+	if (Flash && !alarm()->Flash)
+	{
+		QVector<QcColorBand*>& Bands = mGaugeWidget->mFlashingBands;
+		Bands.reserve(Bands.capacity() + 1);
+	}
+	alarm()->Flash = Flash;
+	mGaugeWidget->setAlarmFlashing(this, Flash && mAlarm->isAlarm(mAlarm->Zone));
+}
+
+
+int QcColorBand::evaluateAlarms(const double* Values, int Count)
+{
+	return evaluateAlarms(Values, Count, alarm()->Clock.elapsed());
+}
+
+
+int QcColorBand::evaluateAlarms(const double* Values, int Count, qint64 Msecs)
+{
+	QcAlarmState* State = alarm();
+	if (State->Limits.isEmpty())
+	{
+		return 0;
+	}
+
+	const double* Limits = State->Limits.constData();
+	int ZoneCount = State->Limits.size();
+	int Transitions = 0;
+	for (int i = 0; i < Count; ++i)
+	{
+		double Value = Values[i];
+		// the common case of a value that stays in its zone costs two
+		// compares
+		if (Value >= State->StayLow && Value <= State->StayHigh)
+		{
+			State->PendingZone = State->Zone;
+			continue;
+		}
+		if (Value != Value)
+		{
+			continue;
+		}
+
+		int Zone = 0;
+		while (Zone < ZoneCount - 1 && Value > Limits[Zone])
+		{
+			++Zone;
+		}
+		if (Zone == State->Zone)
+		{
+			// inside the zone but outside the stay range is not possible,
+			// the stay range contains the zone
+			continue;
+		}
+		if (Zone != State->PendingZone)
+		{
+			State->PendingZone = Zone;
+			State->PendingSince = Msecs;
+		}
+		if (Msecs - State->PendingSince >= State->OnDelay)
+		{
+			commitZone(Zone, Value, Msecs);
+			++Transitions;
+		}
+	}
+	return Transitions;
+}
+
+
+/**
+ * Makes Zone the current zone and records the transition
+ */
+void QcColorBand::commitZone(int Zone, double Value, qint64 Msecs)
+{
+	QcAlarmState* State = mAlarm;
+	int ZoneCount = State->Limits.size();
+	QcAlarmEvent Event;
+	Event.Time = Msecs;
+	Event.Value = Value;
+	Event.Zone = qint16(Zone);
+	Event.PreviousZone = qint16(State->Zone);
+	Event.Alarm = State->isAlarm(Zone);
+
+	// the oldest event is overwritten if the ring buffer is full
+	int Capacity = State->Events.size();
+	State->Events[(State->EventHead + State->EventCount) % Capacity] = Event;
+	if (State->EventCount < Capacity)
+	{
+		State->EventCount++;
+	}
+	else
+	{
+		State->EventHead = (State->EventHead + 1) % Capacity;
+	}
+
+	bool WasFlashing = State->Flash && State->isAlarm(State->Zone);
+	State->Zone = Zone;
+	State->PendingZone = Zone;
+	State->StayLow = (Zone == 0) ? -std::numeric_limits<double>::max()
+		: State->Limits.at(Zone - 1) - State->Hysteresis;
+	State->StayHigh = (Zone == ZoneCount - 1) ? std::numeric_limits<double>::max()
+		: State->Limits.at(Zone) + State->Hysteresis;
+	bool Flashing = State->Flash && Event.Alarm;
+	if (Flashing || WasFlashing)
+	{
+		mGaugeWidget->setAlarmFlashing(this, Flashing);
+	}
+}
+
+
+int QcColorBand::alarmZone() const
+{
+	return mAlarm ? mAlarm->Zone : -1;
+}
+
+
+bool QcColorBand::alarmActive() const
+{
+	return mAlarm && mAlarm->isAlarm(mAlarm->Zone);
+}
+
+
+int QcColorBand::takeAlarmEvents(QcAlarmEvent* Events, int MaxCount)
+{
+	if (!mAlarm)
+	{
+		return 0;
+	}
+	int Count = qMin(MaxCount, mAlarm->EventCount);
+	int Capacity = mAlarm->Events.size();
+	for (int i = 0; i < Count; ++i)
+	{
+		Events[i] = mAlarm->Events.at((mAlarm->EventHead + i) % Capacity);
+	}
+	mAlarm->EventHead = (mAlarm->EventHead + Count) % Capacity;
+	mAlarm->EventCount -= Count;
+	return Count;
+}
+
+
+/**
+ * Paints the sub band of the current zone with a translucent highlight.
+ * The path is cached until the zone, the geometry or the band changes.
+ */
+void QcColorBand::drawAlarmOverlay(QPainter* painter)
+{
+	int Zone = mAlarm->Zone;
+	if (Zone < 0 || Zone >= mBandColors.size())
+	{
+		return;
+	}
+
+	QRectF Rect = itemRect();
+	if (mAlarm->OverlayZone != Zone || mAlarm->OverlayRevision != revision()
+	 || mAlarm->OverlayRect != Rect)
+	{
+		double Start = (Zone == 0) ? mMinValue : mBandColors.at(Zone - 1).second;
+		double offset = getDegFromValue(mBandStartValue)
+			+ getDegFromValue(Start) - getDegFromValue(mMinValue);
+		double sweep = getDegFromValue(mBandColors.at(Zone).second) - getDegFromValue(Start);
+		mAlarm->OverlayPath = createSubBand(-offset, sweep);
+		mAlarm->OverlayPen = QPen(QColor(255, 255, 255, 160),
+			getRadius(widgetRect()) / 20.0 * mPenWidthScaleFactor);
+		mAlarm->OverlayPen.setCapStyle(Qt::FlatCap);
+		mAlarm->OverlayZone = Zone;
+		mAlarm->OverlayRevision = revision();
+		mAlarm->OverlayRect = Rect;
+	}
+	painter->setBrush(Qt::NoBrush);
+	painter->setPen(mAlarm->OverlayPen);
+	painter->drawPath(mAlarm->OverlayPath);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcDegreesItem::QcDegreesItem(QcGaugeWidget* ParentWidget) :
+    QcScaleItem(ParentWidget),
+    mStep(10),
+    mColor(Qt::black),
+    mSubDegree(false)
+{
+    mPosition = 90;
+}
+
+
+bool QcDegreesItem::supportsBandedDraw() const
+{
+	return true;
+}
+
+
+void QcDegreesItem::draw(QPainter *painter)
+{
+    QRectF tmpRect = itemRect();
+
+    painter->setPen(mColor);
+    double r = getRadius(tmpRect);
+    for(double val = mMinValue;val<=mMaxValue;val+=mStep){
+        double deg = getDegFromValue(val);
+        QPointF pt = getPoint(deg,tmpRect);
+        QPainterPath path;
+        path.moveTo(pt);
+        path.lineTo(tmpRect.center());
+        pt = path.pointAtPercent(0.03);
+        QPointF newPt = path.pointAtPercent(mSubDegree ? 0.09 : 0.13);
+
+        QPen pen;
+        pen.setColor(mColor);
+        pen.setWidthF(mSubDegree ? qMax(r/75.0, 0.5) : qMax(r/25.0, 0.75));
+        painter->setPen(pen);
+        painter->drawLine(pt,newPt);
+
+    }
+}
+
+void QcDegreesItem::setStep(double step)
+{
+    mStep = step;
+    invalidate();
+}
+
+void QcDegreesItem::setColor(const QColor& color)
+{
+    mColor = color;
+    invalidate();
+}
+
+void QcDegreesItem::setSubDegree(bool b)
+{
+    mSubDegree = b;
+    invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcSampleFilter::QcSampleFilter(FilterType Type, double Parameter) :
+	mType(Type),
+	mParameter(Parameter),
+	mWindow(qMax(1, qRound(Parameter))),
+	mPrimed(false),
+	mLast(0),
+	mSum(0),
+	mHead(0),
+	mCount(0)
+{
+	if (mType == ExponentialMovingAverage)
+	{
+		mParameter = qBound(std::numeric_limits<double>::min(), Parameter, 1.0);
+	}
+	else if (mType == RateLimit || mType == Deadband)
+	{
+		mParameter = qAbs(Parameter);
+	}
+}
+
+
+QcSampleFilter::FilterType QcSampleFilter::type() const
+{
+	return mType;
+}
+
+
+double QcSampleFilter::parameter() const
+{
+	return mParameter;
+}
+
+
+void QcSampleFilter::reset()
+{
+	mPrimed = false;
+	mSum = 0;
+	mHead = 0;
+	mCount = 0;
+}
+
+
+void QcSampleFilter::process(const double* Input, double* Output, int Count)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	// The recursive filters depend on the previous output, so they run as
+	// tight loops over the arrays without any per sample dispatch
+	int i = 0;
+	if (!mPrimed && mType != MovingAverage && mType != Median)
+	{
+		mLast = Input[0];
+		Output[0] = mLast;
+		mPrimed = true;
+		i = 1;
+	}
+
+	double Last = mLast;
+	double Parameter = mParameter;
+	switch (mType)
+	{
+	case NoFilter:
+		if (Output != Input)
+		{
+			memcpy(Output, Input, Count * sizeof(double));
+		}
+		Last = Input[Count - 1];
+		break;
+
+	case ExponentialMovingAverage:
+		for (; i < Count; ++i)
+		{
+			Last += Parameter * (Input[i] - Last);
+			Output[i] = Last;
+		}
+		break;
+
+	case RateLimit:
+		for (; i < Count; ++i)
+		{
+			Last += qBound(-Parameter, Input[i] - Last, Parameter);
+			Output[i] = Last;
+		}
+		break;
+
+	case Deadband:
+		for (; i < Count; ++i)
+		{
+			if (qAbs(Input[i] - Last) > Parameter)
+			{
+				Last = Input[i];
+			}
+			Output[i] = Last;
+		}
+		break;
+
+	case MovingAverage:
+	case Median:
+		processWindow(Input, Output, Count);
+		return;
+	}
+	mLast = Last;
+}
+
+
+/**
+ * Filters with a window over the last mWindow samples. The window is kept in
+ * the ring buffer mRing. The moving average updates a running sum by the
+ * entering and the leaving sample, so each sample costs O(1). Batches of at
+ * least mWindow samples after the window is full go to averageBlock().
+ * The median keeps the window sorted in mScratch. A sample moves the leaving
+ * value to the position of the entering one, so there is a binary search
+ * and a move of the values in between, but no selection per sample.
+ */
+void QcSampleFilter::processWindow(const double* Input, double* Output, int Count)
+{
+	if (mRing.size() != mWindow)
+	{
+		mRing.resize(mWindow);
+	}
+	if (mScratch.size() != mWindow)
+	{
+		mScratch.resize(mWindow);
+	}
+	double* Ring = mRing.data();
+
+	if (mType == MovingAverage)
+	{
+		int First = (mCount < mWindow) ? qMin(Count, mWindow - mCount) : 0;
+		if (Count - First < mWindow)
+		{
+			First = Count;
+		}
+		for (int i = 0; i < First; ++i)
+		{
+			double Sample = Input[i];
+			if (mCount == mWindow)
+			{
+				mSum -= Ring[mHead];
+			}
+			else
+			{
+				++mCount;
+			}
+			Ring[mHead] = Sample;
+			mSum += Sample;
+			if (++mHead == mWindow)
+			{
+				mHead = 0;
+				mSum = std::accumulate(Ring, Ring + mCount, 0.0);
+			}
+			Output[i] = mSum / mCount;
+		}
+		if (First < Count)
+		{
+			averageBlock(Input + First, Output + First, Count - First);
+		}
+	}
+	else
+	{
+		double* Sorted = mScratch.data();
+		for (int i = 0; i < Count; ++i)
+		{
+			double Sample = Input[i];
+			if (mCount == mWindow)
+			{
+				double* Slot = std::lower_bound(Sorted, Sorted + mCount, Ring[mHead]);
+				double* Target = std::lower_bound(Sorted, Sorted + mCount, Sample);
+				if (Target > Slot)
+				{
+					std::copy(Slot + 1, Target, Slot);
+					Target[-1] = Sample;
+				}
+				else
+				{
+					std::copy_backward(Target, Slot, Slot + 1);
+					*Target = Sample;
+				}
+			}
+			else
+			{
+				double* Target = std::upper_bound(Sorted, Sorted + mCount, Sample);
+				std::copy_backward(Target, Sorted + mCount, Sorted + mCount + 1);
+				*Target = Sample;
+				++mCount;
+			}
+			Ring[mHead] = Sample;
+			mHead = (mHead + 1 == mWindow) ? 0 : mHead + 1;
+			Output[i] = Sorted[mCount / 2];
+		}
+	}
+	mPrimed = true;
+}
+
+
+/**
+ * Moving average of a batch of at least mWindow samples with a full window.
+ * The differences of the entering and the leaving samples have no
+ * dependencies between each other, so these loops vectorize, and a prefix
+ * sum over the differences gives the window sums. The leaving samples of
+ * the first mWindow outputs come from the ring, the others from the batch
+ * itself. Input and Output may be the same array, so the differences to
+ * the batch are computed backwards before the ring part overwrites the
+ * front. The sum is recomputed from the new window after each batch.
+ */
+void QcSampleFilter::averageBlock(const double* Input, double* Output, int Count)
+{
+	const int Window = mWindow;
+	const double* Ring = mRing.constData();
+	double* Tail = mScratch.data();
+	std::copy(Input + Count - Window, Input + Count, Tail);
+
+	for (int i = Count - 1; i >= Window; --i)
+	{
+		Output[i] = Input[i] - Input[i - Window];
+	}
+	const int Wrap = Window - mHead;
+	for (int i = 0; i < Wrap; ++i)
+	{
+		Output[i] = Input[i] - Ring[mHead + i];
+	}
+	for (int i = Wrap; i < Window; ++i)
+	{
+		Output[i] = Input[i] - Ring[i - Wrap];
+	}
+
+	const double Scale = 1.0 / Window;
+	double Sum = mSum;
+	for (int i = 0; i < Count; ++i)
+	{
+		Sum += Output[i];
+		Output[i] = Sum * Scale;
+	}
+
+	mRing.swap(mScratch);
+	mHead = 0;
+	mSum = std::accumulate(mRing.constBegin(), mRing.constEnd(), 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sliding window maximum or minimum of a sample sequence.
+ * The queue keeps only the samples that may still become the extremum,
+ * so the values in the queue are monotonic and the front is the current
+ * extremum. Each sample is added and removed once, which makes an update
+ * O(1) amortized.
+ */
+class QcMonotonicQueue
+{
+public:
+	struct Entry
+	{
+		qint64 Index; ///< sequence number of the sample
+		qint64 Time; ///< milliseconds of the hold clock
+		double Value;
+	};
+
+	explicit QcMonotonicQueue(bool Maximum) : mHead(0), mMaximum(Maximum) {}
+
+	bool isEmpty() const {return mHead >= mEntries.size();}
+	double front() const {return mEntries.at(mHead).Value;}
+	qint64 frontTime() const {return mEntries.at(mHead).Time;}
+
+	void push(const Entry& Sample)
+	{
+		while (!isEmpty() && (mMaximum ? mEntries.last().Value <= Sample.Value
+			: mEntries.last().Value >= Sample.Value))
+		{
+			mEntries.removeLast();
+		}
+		mEntries.append(Sample);
+	}
+
+	/**
+	 * Removes all samples before MinIndex or older than MinTime
+	 */
+	void expire(qint64 MinIndex, qint64 MinTime)
+	{
+		while (!isEmpty() && (mEntries.at(mHead).Index < MinIndex
+			|| mEntries.at(mHead).Time < MinTime))
+		{
+			++mHead;
+		}
+		// drop the consumed entries once they occupy half of the storage
+		if (mHead >= 32 && 2 * mHead >= mEntries.size())
+		{
+			mEntries.remove(0, mHead);
+			mHead = 0;
+		}
+	}
+
+	void clear()
+	{
+		mEntries.clear();
+		mHead = 0;
+	}
+
+private:
+	QVector<Entry> mEntries;
+	int mHead; ///< index of the front entry in mEntries
+	bool mMaximum;
+};
+
+
+/**
+ * Peak and minimum hold state of a needle
+ */
+class QcHoldTracker
+{
+public:
+	QcHoldTracker() :
+		Peaks(true),
+		Minimums(false),
+		NextIndex(0),
+		WindowMsecs(10000),
+		WindowSamples(0),
+		PeakHold(false),
+		MinimumHold(false),
+		MarkerBrush(Qt::red)
+	{
+		Clock.start();
+	}
+
+	bool enabled() const {return PeakHold || MinimumHold;}
+
+	/**
+	 * Adds a sample and returns true, if the peak or the minimum changed
+	 */
+	bool addSample(double Value)
+	{
+		if (!enabled())
+		{
+			return false;
+		}
+		bool HadPeak = PeakHold && !Peaks.isEmpty();
+		bool HadMinimum = MinimumHold && !Minimums.isEmpty();
+		double Peak = HadPeak ? Peaks.front() : 0;
+		double Minimum = HadMinimum ? Minimums.front() : 0;
+
+		QcMonotonicQueue::Entry Sample = {NextIndex++, Clock.elapsed(), Value};
+		if (PeakHold)
+		{
+			Peaks.push(Sample);
+		}
+		if (MinimumHold)
+		{
+			Minimums.push(Sample);
+		}
+		expire(Sample.Time);
+		return (PeakHold && (!HadPeak || Peaks.front() != Peak))
+			|| (MinimumHold && (!HadMinimum || Minimums.front() != Minimum));
+	}
+
+	void expire(qint64 Now)
+	{
+		qint64 MinIndex = (WindowSamples > 0) ? NextIndex - WindowSamples
+			: std::numeric_limits<qint64>::min();
+		qint64 MinTime = (WindowMsecs > 0) ? Now - WindowMsecs
+			: std::numeric_limits<qint64>::min();
+		Peaks.expire(MinIndex, MinTime);
+		Minimums.expire(MinIndex, MinTime);
+	}
+
+	void expire()
+	{
+		expire(Clock.elapsed());
+	}
+
+	/**
+	 * Returns the milliseconds until the oldest held sample leaves the time
+	 * window or -1 if no held sample expires by time
+	 */
+	int nextExpiry() const
+	{
+		if (WindowMsecs <= 0)
+		{
+			return -1;
+		}
+		qint64 Oldest = std::numeric_limits<qint64>::max();
+		if (PeakHold && !Peaks.isEmpty())
+		{
+			Oldest = Peaks.frontTime();
+		}
+		if (MinimumHold && !Minimums.isEmpty())
+		{
+			Oldest = qMin(Oldest, Minimums.frontTime());
+		}
+		if (Oldest == std::numeric_limits<qint64>::max())
+		{
+			return -1;
+		}
+		return int(qMax(Q_INT64_C(1), Oldest + WindowMsecs + 1 - Clock.elapsed()));
+	}
+
+	QcMonotonicQueue Peaks;
+	QcMonotonicQueue Minimums;
+	QElapsedTimer Clock;
+	qint64 NextIndex; ///< sequence number of the next sample
+	int WindowMsecs;
+	int WindowSamples;
+	bool PeakHold;
+	bool MinimumHold;
+	QBrush MarkerBrush;
+};
+
+
+QcNeedleItem::QcNeedleItem(QcGaugeWidget* ParentWidget) :
+    QcScaleItem(ParentWidget),
+    mNeedlePolyRadius(-1),
+    mCurrentValue(0),
+    mCurrentDegree(0),
+    mDegreeRevision(0),
+    mLabelDirty(false),
+    mLabelScale(10),
+    mPainted(false),
+    mPaintedDegree(0),
+    mPaintedTipRadius(0),
+    mPaintedLabelKey(0),
+    mSuppressedUpdates(0),
+    mProxy(0),
+    mHold(0),
+    mFilter(0),
+    mAlarmBand(0),
+    mEnvelope(false),
+    mEnvelopeMin(0),
+    mEnvelopeMax(0),
+    mFrameMin(0),
+    mFrameMax(0),
+    mEnvelopeBrush(QColor(255, 0, 0, 64)),
+    mEnvelopePolygonMin(0),
+    mEnvelopePolygonMax(0),
+    mModelChannel(-1),
+    mNeedleType(FeatherNeedle),
+    mLabel(0),
+    mBrush(Qt::black),
+    mDropShadowDiameter(0),
+    mDropShadow(false),
+    mThicknessFactor(1),
+    mDecimals(1)
+{
+
+}
+
+
+QcNeedleItem::~QcNeedleItem()
+{
+	setAlarmBand(0);
+	delete mProxy;
+	delete mHold;
+	delete mFilter;
+}
+
+
+bool QcNeedleItem::isDynamic() const
+{
+	return true;
+}
+
+
+QcNeedleProxy* QcNeedleItem::proxy()
+{
+	if (!mProxy)
+	{
+		mProxy = new QcNeedleProxy(this);
+	}
+	return mProxy;
+}
+
+/**
+ * Accumulates the signed area the line from (x0, y0) to (x1, y1) covers in
+ * each pixel of the accumulation buffer Acc with Stride floats per line.
+ * Summing up a line of the buffer from left to right yields the exact area
+ * coverage of each pixel by the closed polygon, including the pixels at
+ * acute corners. The points must lie within [0, Stride - 2] x [0, Height].
+ * This is the accumulation rasterizer of font-rs.
+ */
+static void accumulateLine(float* Acc, int Stride, int Height, double x0,
+	double y0, double x1, double y1)
+{
+	if (qAbs(y1 - y0) < 1e-9)
+	{
+		return;
+	}
+
+	double Direction = 1;
+	if (y0 > y1)
+	{
+		std::swap(x0, x1);
+		std::swap(y0, y1);
+		Direction = -1;
+	}
+
+	const double dxdy = (x1 - x0) / (y1 - y0);
+	const int EndLine = qMin(Height, int(ceil(y1)));
+	double x = x0;
+	for (int y = int(y0); y < EndLine; ++y)
+	{
+		float* Line = Acc + y * Stride;
+		const double dy = qMin(double(y + 1), y1) - qMax(double(y), y0);
+		const double xNext = x + dxdy * dy;
+		const double d = dy * Direction;
+		const double Left = qMin(x, xNext);
+		const double Right = qMax(x, xNext);
+		const double LeftFloor = floor(Left);
+		const int LeftIndex = int(LeftFloor);
+		const double RightCeil = ceil(Right);
+		const int RightIndex = int(RightCeil);
+		if (RightIndex <= LeftIndex + 1)
+		{
+			// the line stays within one pixel column
+			const double xm = 0.5 * (x + xNext) - LeftFloor;
+			Line[LeftIndex] += d - d * xm;
+			Line[LeftIndex + 1] += d * xm;
+		}
+		else
+		{
+			const double s = 1.0 / (Right - Left);
+			const double LeftFraction = Left - LeftFloor;
+			const double a0 = 0.5 * s * (1 - LeftFraction) * (1 - LeftFraction);
+			const double RightFraction = Right - RightCeil + 1;
+			const double am = 0.5 * s * RightFraction * RightFraction;
+			Line[LeftIndex] += d * a0;
+			if (RightIndex == LeftIndex + 2)
+			{
+				Line[LeftIndex + 1] += d * (1 - a0 - am);
+			}
+			else
+			{
+				const double a1 = s * (1.5 - LeftFraction);
+				Line[LeftIndex + 1] += d * (a1 - a0);
+				for (int i = LeftIndex + 2; i < RightIndex - 1; ++i)
+				{
+					Line[i] += d * s;
+				}
+				const double a2 = a1 + (RightIndex - LeftIndex - 3) * s;
+				Line[RightIndex - 1] += d * (1 - a2 - am);
+			}
+			Line[RightIndex] += d * am;
+		}
+		x = xNext;
+	}
+}
+
+
+/**
+ * Converts the accumulated area of Count pixels into premultiplied pixels
+ * of the solid colour Color. Without antialiasing, pixels that are at least
+ * half covered are set.
+ */
+static void solidCoverageSpan(uint* Line, const float* Acc, int Count, uint Color,
+	bool Antialiased)
+{
+	float Sum = 0;
+	if (Antialiased)
+	{
+		for (int x = 0; x < Count; ++x)
+		{
+			Sum += Acc[x];
+			Line[x] = multiplyPixel(Color, uint(qMin(qAbs(Sum), 1.0f) * 255.0f + 0.5f));
+		}
+	}
+	else
+	{
+		for (int x = 0; x < Count; ++x)
+		{
+			Sum += Acc[x];
+			Line[x] = Color & (0u - uint(qAbs(Sum) >= 0.5f));
+		}
+	}
+}
+
+
+/**
+ * Converts the accumulated area of Count pixels into premultiplied pixels
+ * of a gradient brush. t is the gradient position of the first pixel and
+ * dt the step per pixel.
+ */
+static void gradientCoverageSpan(uint* Line, const float* Acc, int Count,
+	const uint* Table, double t, double dt, bool Antialiased)
+{
+	float Sum = 0;
+	for (int x = 0; x < Count; ++x)
+	{
+		Sum += Acc[x];
+		uint Color = Table[qBound(0, int(t * 255 + 0.5), 255)];
+		uint Coverage = Antialiased ? uint(qMin(qAbs(Sum), 1.0f) * 255.0f + 0.5f)
+			: (qAbs(Sum) >= 0.5f) * 255u;
+		Line[x] = multiplyPixel(Color, Coverage);
+		t += dt;
+	}
+}
+
+
+void QcNeedleItem::draw(QPainter *painter)
+{
+	double deg = prepareFrame();
+	drawDecorations(painter, deg);
+
+    // A steady state frame does not allocate memory: the needle polygon is
+    // cached per radius and only the painter transform is restored instead
+    // of saving the complete painter state
+    const QTransform Transform = painter->transform();
+    painter->translate(itemRect().center());
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(mBrush);
+    painter->rotate(deg + 90.0);
+    painter->drawConvexPolygon(mNeedlePoly);
+    painter->setTransform(Transform);
+}
+
+
+/**
+ * Updates the value, the label text and the needle polygon for the next
+ * paint and returns the needle angle
+ */
+double QcNeedleItem::prepareFrame()
+{
+	syncModelValue();
+	if (mHold)
+	{
+		mHold->expire();
+	}
+	if (mEnvelope)
+	{
+		// the next frame starts at the value the needle shows now
+		mFrameMin = mEnvelopeMin;
+		mFrameMax = mEnvelopeMax;
+		mEnvelopeMin = mEnvelopeMax = mCurrentValue;
+	}
+	if (mLabel && mLabelDirty
+	 && mGaugeWidget->qualityLevel() < QcGaugeWidget::NoLabelUpdate)
+	{
+		mLabel->setValueText(mCurrentValue, mDecimals, false);
+		mPaintedLabelKey = floor(mCurrentValue * mLabelScale + 0.5);
+		mLabelDirty = false;
+	}
+
+	double deg = currentDegree();
+	needlePoly(getRadius(itemRect()));
+	const QRectF& NeedleRect = mNeedlePolyRect;
+	mPaintedTipRadius = qMax(qMax(-NeedleRect.top(), NeedleRect.bottom()),
+		qMax(-NeedleRect.left(), NeedleRect.right()));
+	mPaintedDegree = deg;
+	mPainted = true;
+	return deg;
+}
+
+
+/**
+ * Draws the linked label, the envelope, the hold markers and the drop
+ * shadow below the needle
+ */
+void QcNeedleItem::drawDecorations(QPainter* painter, double Degree)
+{
+	if (mLabel)
+	{
+		mLabel->draw(painter);
+	}
+
+	if (mEnvelope && mFrameMax > mFrameMin)
+	{
+		drawEnvelope(painter);
+		// the envelope only spans the values since the previous paint, so a
+		// frame without new values has to clear it
+		updateAfter(1);
+	}
+
+	if (mHold && mHold->enabled())
+	{
+		double Radius = getRadius(itemRect());
+		painter->setPen(Qt::NoPen);
+		painter->setBrush(mHold->MarkerBrush);
+		if (mHold->PeakHold && !mHold->Peaks.isEmpty())
+		{
+			drawHoldMarker(painter, mHold->Peaks.front(), Radius);
+		}
+		if (mHold->MinimumHold && !mHold->Minimums.isEmpty())
+		{
+			drawHoldMarker(painter, mHold->Minimums.front(), Radius);
+		}
+		// repaint when the oldest marker expires even if no sample arrives
+		int Expiry = mHold->nextExpiry();
+		if (Expiry > 0)
+		{
+			updateAfter(Expiry);
+		}
+	}
+
+	if (!mDropShadow || mGaugeWidget->qualityLevel() >= QcGaugeWidget::NoNeedleShadow)
+	{
+		return;
+	}
+
+	// the shadow is created lazily and recreated if the size changed
+	if (mDropShadowImage.isNull() || mDropShadowDiameter != mGaugeWidget->diameter())
+	{
+		updateDropShadowImage();
+	}
+	const QRectF& NeedleRect = mNeedlePolyRect;
+	int yOffset = round((mDropShadowImage.height() - NeedleRect.height()) / 2.0 - NeedleRect.top());
+	const QTransform Transform = painter->transform();
+	QPainter::RenderHints Hints = painter->renderHints();
+	painter->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+	painter->translate(itemRect().center());
+	painter->translate(mGaugeWidget->shadowOffset());
+	painter->rotate(Degree + 90.0);
+	painter->translate(QPointF(0, -yOffset));
+	painter->drawImage(QPointF(-(mDropShadowImage.width() / 2), 0), mDropShadowImage);
+	painter->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform, false);
+	painter->setRenderHints(Hints);
+	painter->setTransform(Transform);
+}
+
+
+/**
+ * Maximum angle between two points of the envelope arc in degree
+ */
+static const double EnvelopeArcStep = 5;
+static const int MaxEnvelopePoints = 2 + int(360 / EnvelopeArcStep);
+
+
+/**
+ * Draws the sector from mFrameMin to mFrameMax. The sector is a polygon of
+ * the centre and points on the arc. It is rebuilt in place if the
+ * envelope angles or the item rect changed, so drawing the envelope does
+ * not allocate memory.
+ */
+void QcNeedleItem::drawEnvelope(QPainter* painter)
+{
+	QRectF Rect = itemRect();
+	double MinDegree = getDegFromValue(mFrameMin);
+	double MaxDegree = getDegFromValue(mFrameMax);
+	if (MinDegree != mEnvelopePolygonMin || MaxDegree != mEnvelopePolygonMax
+	 || Rect != mEnvelopePolygonRect)
+	{
+		if (mEnvelopePolygon.capacity() < MaxEnvelopePoints)
+		{
+			mEnvelopePolygon.reserve(MaxEnvelopePoints);
+		}
+		double Sweep = qMin(MaxDegree - MinDegree, 360.0);
+		int Segments = qMax(1, int(ceil(Sweep / EnvelopeArcStep)));
+		mEnvelopePolygon.resize(Segments + 2);
+		QPointF* Points = mEnvelopePolygon.data();
+		QPointF Center = Rect.center();
+		double RadiusX = Rect.width() / 2;
+		double RadiusY = Rect.height() / 2;
+		Points[0] = Center;
+		for (int i = 0; i <= Segments; ++i)
+		{
+			double Degree = qDegreesToRadians(MinDegree + Sweep * i / Segments);
+			Points[i + 1] = QPointF(Center.x() - RadiusX * cos(Degree),
+				Center.y() - RadiusY * sin(Degree));
+		}
+		mEnvelopePolygonMin = MinDegree;
+		mEnvelopePolygonMax = MaxDegree;
+		mEnvelopePolygonRect = Rect;
+	}
+	painter->setPen(Qt::NoPen);
+	painter->setBrush(mEnvelopeBrush);
+	painter->drawPolygon(mEnvelopePolygon.constData(), mEnvelopePolygon.size());
+}
+
+
+/**
+ * Draws a small triangle at the rim of the item rect that points to the
+ * scale position of Value
+ */
+void QcNeedleItem::drawHoldMarker(QPainter* painter, double Value, double Radius)
+{
+	double Degree = qDegreesToRadians(getDegFromValue(Value));
+	QPointF Center = itemRect().center();
+	// unit vector from the rim to the centre and its normal
+	QPointF Inward(cos(Degree), sin(Degree));
+	QPointF Normal(-Inward.y(), Inward.x());
+	double Size = Radius * 0.06;
+	QPointF Rim = Center - Inward * Radius;
+	QPointF Marker[3] = {
+		Rim + Inward * Size,
+		Rim + Normal * (Size * 0.6),
+		Rim - Normal * (Size * 0.6)};
+	painter->drawConvexPolygon(Marker, 3);
+}
+
+
+/**
+ * Returns true, if rasterize() supports the brush of this needle
+ */
+bool QcNeedleItem::canRasterize() const
+{
+	if (!mBrush.transform().isIdentity())
+	{
+		return false;
+	}
+
+	switch (mBrush.style())
+	{
+	case Qt::SolidPattern:
+		return true;
+
+	case Qt::LinearGradientPattern:
+		return mBrush.gradient()->spread() == QGradient::PadSpread
+			&& !mBrush.gradient()->stops().isEmpty()
+			&& (mBrush.gradient()->coordinateMode() == QGradient::LogicalMode
+			 || mBrush.gradient()->coordinateMode() == QGradient::ObjectBoundingMode);
+
+	default:
+		return false;
+	}
+}
+
+
+/**
+ * Rasterizes the needle polygon into the top left corner of the
+ * ARGB32_Premultiplied image Buffer, which is enlarged if required. Only
+ * the bounding box of the needle is written. Returns the bounding box in
+ * the coordinate system of the layer images.
+ */
+QRect QcNeedleItem::rasterize(QImage& Buffer, double Degree, bool Antialiased)
+{
+	QTransform Transform;
+	Transform.translate(itemRect().center().x(), itemRect().center().y());
+	Transform.rotate(Degree + 90.0);
+	const int Count = mNeedlePoly.size();
+	if (Count < 3)
+	{
+		return QRect();
+	}
+	QVarLengthArray<QPointF, 32> Points(Count);
+	for (int i = 0; i < Count; ++i)
+	{
+		Points[i] = Transform.map(mNeedlePoly.at(i));
+	}
+
+	double MinX = Points[0].x();
+	double MaxX = MinX;
+	double MinY = Points[0].y();
+	double MaxY = MinY;
+	for (int i = 1; i < Count; ++i)
+	{
+		MinX = qMin(MinX, Points[i].x());
+		MaxX = qMax(MaxX, Points[i].x());
+		MinY = qMin(MinY, Points[i].y());
+		MaxY = qMax(MaxY, Points[i].y());
+	}
+	const QRect Rect(int(floor(MinX)), int(floor(MinY)),
+		int(ceil(MaxX) - floor(MinX)) + 1, int(ceil(MaxY) - floor(MinY)));
+	if (Rect.width() <= 1 || Rect.height() <= 0)
+	{
+		return QRect();
+	}
+
+	QcSpanBrush Brush = solidSpanBrush(mBrush.color());
+	if (mBrush.style() == Qt::LinearGradientPattern)
+	{
+		const QLinearGradient* Gradient = static_cast<const QLinearGradient*>(mBrush.gradient());
+		QPointF Start = Gradient->start();
+		QPointF Stop = Gradient->finalStop();
+		if (Gradient->coordinateMode() == QGradient::ObjectBoundingMode)
+		{
+			const QRectF& Rect = mNeedlePolyRect;
+			Start = QPointF(Rect.left() + Start.x() * Rect.width(), Rect.top() + Start.y() * Rect.height());
+			Stop = QPointF(Rect.left() + Stop.x() * Rect.width(), Rect.top() + Stop.y() * Rect.height());
+		}
+
+		if (mGradientTable.isEmpty())
+		{
+			mGradientTable.resize(256);
+			gradientTable(Gradient->stops(), mGradientTable.data());
+		}
+
+		// gradient position of a device pixel: map it back into needle
+		// coordinates and project it on the gradient vector
+		QTransform Inverse = Transform.inverted();
+		double dx = Stop.x() - Start.x();
+		double dy = Stop.y() - Start.y();
+		double Length2 = dx * dx + dy * dy;
+		if (Length2 > 0)
+		{
+			Brush.A = (dx * Inverse.m11() + dy * Inverse.m12()) / Length2;
+			Brush.B = (dx * Inverse.m21() + dy * Inverse.m22()) / Length2;
+			Brush.C = (dx * (Inverse.dx() - Start.x()) + dy * (Inverse.dy() - Start.y())) / Length2;
+		}
+		Brush.Table = mGradientTable.constData();
+	}
+
+	// the accumulation buffer has a spare column for the area that the
+	// lines carry over the right border of the bounding box
+	const int Stride = Rect.width() + 1;
+	const int Size = Stride * Rect.height();
+	if (mCoverage.size() < Size)
+	{
+		mCoverage.resize(Size);
+	}
+	float* Acc = mCoverage.data();
+	std::fill(Acc, Acc + Size, 0.0f);
+	for (int i = 0; i < Count; ++i)
+	{
+		const QPointF& p = Points[i];
+		const QPointF& q = Points[(i + 1) % Count];
+		accumulateLine(Acc, Stride, Rect.height(), p.x() - Rect.left(),
+			p.y() - Rect.top(), q.x() - Rect.left(), q.y() - Rect.top());
+	}
+
+	if (Buffer.width() < Rect.width() || Buffer.height() < Rect.height())
+	{
+		Buffer = QImage(qMax(Buffer.width(), Rect.width()),
+			qMax(Buffer.height(), Rect.height()), QImage::Format_ARGB32_Premultiplied);
+	}
+	uchar* Bits = Buffer.bits();
+	const int BytesPerLine = Buffer.bytesPerLine();
+	for (int y = 0; y < Rect.height(); ++y)
+	{
+		uint* Line = reinterpret_cast<uint*>(Bits + y * BytesPerLine);
+		const float* AccLine = Acc + y * Stride;
+		if (Brush.Table)
+		{
+			const double yc = Rect.top() + y + 0.5;
+			const double xc = Rect.left() + 0.5;
+			gradientCoverageSpan(Line, AccLine, Rect.width(), Brush.Table,
+				Brush.A * xc + Brush.B * yc + Brush.C, Brush.A, Antialiased);
+		}
+		else
+		{
+			solidCoverageSpan(Line, AccLine, Rect.width(), Brush.Color, Antialiased);
+		}
+	}
+	return Rect;
+}
+
+
+void QcNeedleItem::setDropShadow(bool DropShadow)
+{
+	mDropShadow = DropShadow;
+	mDropShadowImage = QImage();
+	update();
+}
+
+
+bool QcNeedleItem::dropShadow() const
+{
+	return mDropShadow;
+}
+
+
+void QcNeedleItem::updateDropShadowImage()
+{
+	if (!mDropShadow)
+	{
+		return;
+	}
+
+    QRectF tmpRect = itemRect();
+	const QPolygonF& NeedlePoly = needlePoly(getRadius(tmpRect));
+    QImage ShadowImage(NeedlePoly.boundingRect().size().toSize(), QImage::Format_ARGB32_Premultiplied);
+    ShadowImage.fill(Qt::transparent);
+    {
+    	QPainter Painter(&ShadowImage);
+		Painter.setRenderHint(QPainter::Antialiasing);
+		Painter.setBrush(mGaugeWidget->shadowBrush());
+		Painter.setPen(Qt::NoPen);
+		Painter.translate(NeedlePoly.boundingRect().width() / 2, - NeedlePoly.boundingRect().top());
+		Painter.drawConvexPolygon(NeedlePoly);
+    }
+    mDropShadowImage = compactShadowImage(mGaugeWidget->blurShadowImage(ShadowImage),
+    	mGaugeWidget->shadowBrush());
+    mDropShadowDiameter = mGaugeWidget->diameter();
+}
+
+
+void QcNeedleItem::releaseCache()
+{
+	QcItem::releaseCache();
+	mDropShadowImage = QImage();
+	mCoverage = QVector<float>();
+}
+
+
+qint64 QcNeedleItem::cacheSize() const
+{
+	return QcItem::cacheSize() + imageBytes(mDropShadowImage)
+		+ qint64(mCoverage.capacity()) * sizeof(float);
+}
+
+
+void QcNeedleItem::setDecimals(int Decimals)
+{
+	mDecimals = Decimals;
+	mLabelScale = qPow(10.0, Decimals);
+	mLabelDirty = true;
+	update();
+}
+
+
+int QcNeedleItem::decimals() const
+{
+	return mDecimals;
+}
+
+
+void QcNeedleItem::setValue(double value)
+{
+	addSamples(&value, 1);
+}
+
+
+void QcNeedleItem::addSamples(const double* Values, int Count)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	if (mModel)
+	{
+		QVarLengthArray<int, 256> Channels(Count);
+		std::fill(Channels.begin(), Channels.end(), mModelChannel);
+		mModel->setValues(Channels.constData(), Values, Count);
+		return;
+	}
+
+	QVarLengthArray<double, 256> Filtered;
+	if (mFilter)
+	{
+		Filtered.resize(Count);
+		mFilter->process(Values, Filtered.data(), Count);
+		Values = Filtered.constData();
+	}
+	if (mAlarmBand)
+	{
+		mAlarmBand->evaluateAlarms(Values, Count);
+	}
+
+	bool HoldChanged = false;
+	bool EnvelopeChanged = false;
+	for (int i = 0; i < Count; ++i)
+	{
+		double Value = qBound(mMinValue, Values[i], mMaxValue);
+		if (mHold && mHold->addSample(Value))
+		{
+			HoldChanged = true;
+		}
+		if (extendEnvelope(Value))
+		{
+			EnvelopeChanged = true;
+		}
+	}
+
+    mCurrentValue = qBound(mMinValue, Values[Count - 1], mMaxValue);
+    mCurrentDegree = getDegFromValue(mCurrentValue);
+    mDegreeRevision = revision();
+    mLabelDirty = true;
+    if (mGaugeWidget->isDormant())
+    {
+    	return;
+    }
+    if (!HoldChanged && !EnvelopeChanged && !changesVisibly(mCurrentValue, mCurrentDegree))
+    {
+    	mSuppressedUpdates++;
+    	return;
+    }
+    update();
+}
+
+
+/**
+ * Returns true if painting the needle with the given value and angle would
+ * visibly differ from the last paint. This is the case if the needle tip
+ * moves by half a device pixel or more or if the label text changes.
+ */
+bool QcNeedleItem::changesVisibly(double Value, double Degree) const
+{
+	if (!mPainted)
+	{
+		return true;
+	}
+
+	double TipDelta = qAbs(qDegreesToRadians(Degree - mPaintedDegree))
+		* mPaintedTipRadius * mGaugeWidget->devicePixelRatioF();
+	if (TipDelta >= 0.5)
+	{
+		return true;
+	}
+
+	if (mLabel)
+	{
+		double Scaled = Value * mLabelScale;
+		double Key = floor(Scaled + 0.5);
+		// values next to a rounding boundary may be formatted either way
+		if (Key != mPaintedLabelKey || qAbs(Scaled - Key) > 0.499)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+quint64 QcNeedleItem::suppressedUpdates() const
+{
+	return mSuppressedUpdates;
+}
+
+
+/**
+ * Clamps Values to [Min, Max] and maps the clamped values to needle angles.
+ * The loop has no dependencies between iterations, so the compiler can
+ * vectorize it.
+ */
+static void clampAndMapValues(const double* Values, const double* Min,
+	const double* Max, const double* Scale, const double* Offset,
+	double* ClampedValues, double* Degrees, int Count)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		double Value = qMin(qMax(Values[i], Min[i]), Max[i]);
+		ClampedValues[i] = Value;
+		Degrees[i] = Scale[i] * Value + Offset[i];
+	}
+}
+
+
+void QcNeedleItem::setValues(QcNeedleItem* const* Needles,
+	const double* Values, int Count)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	QVarLengthArray<double, 256> Min(Count);
+	QVarLengthArray<double, 256> Max(Count);
+	QVarLengthArray<double, 256> Scale(Count);
+	QVarLengthArray<double, 256> Offset(Count);
+	QVarLengthArray<double, 256> FilteredValues(Count);
+	QVarLengthArray<double, 256> ClampedValues(Count);
+	QVarLengthArray<double, 256> Degrees(Count);
+	for (int i = 0; i < Count; ++i)
+	{
+		QcNeedleItem* Needle = Needles[i];
+		FilteredValues[i] = Values[i];
+		if (Needle->mModel)
+		{
+			// like addSamples(), a bound needle writes into its model and
+			// shows the model value on the next paint
+			Needle->mModel->setValue(Needle->mModelChannel, Values[i]);
+		}
+		else if (Needle->mFilter)
+		{
+			Needle->mFilter->process(&FilteredValues[i], &FilteredValues[i], 1);
+		}
+		if (Needle->mAlarmBand && !Needle->mModel)
+		{
+			Needle->mAlarmBand->evaluateAlarms(&FilteredValues[i], 1);
+		}
+		Min[i] = Needle->mMinValue;
+		Max[i] = Needle->mMaxValue;
+		Scale[i] = (Needle->mMaxDegree - Needle->mMinDegree)
+			/ (Needle->mMaxValue - Needle->mMinValue);
+		Offset[i] = -Scale[i] * Needle->mMinValue + Needle->mMinDegree;
+	}
+
+	clampAndMapValues(FilteredValues.constData(), Min.constData(), Max.constData(),
+		Scale.constData(), Offset.constData(), ClampedValues.data(),
+		Degrees.data(), Count);
+
+	QVarLengthArray<QcGaugeWidget*, 64> Widgets;
+	for (int i = 0; i < Count; ++i)
+	{
+		QcNeedleItem* Needle = Needles[i];
+		if (Needle->mModel)
+		{
+			continue;
+		}
+		Needle->mCurrentValue = ClampedValues[i];
+		Needle->mCurrentDegree = Degrees[i];
+		Needle->mDegreeRevision = Needle->revision();
+		Needle->mLabelDirty = true;
+		bool HoldChanged = Needle->mHold
+			&& Needle->mHold->addSample(ClampedValues[i]);
+		bool EnvelopeChanged = Needle->extendEnvelope(ClampedValues[i]);
+		if (Needle->mGaugeWidget->isDormant())
+		{
+			continue;
+		}
+		if (!HoldChanged && !EnvelopeChanged && !Needle->changesVisibly(ClampedValues[i], Degrees[i]))
+		{
+			Needle->mSuppressedUpdates++;
+			continue;
+		}
+		QcGaugeWidget* Widget = Needle->mGaugeWidget;
+		if (!Widget->mValuesPending)
+		{
+			Widget->mValuesPending = true;
+			Widgets.append(Widget);
+		}
+	}
+
+	for (int i = 0; i < Widgets.size(); ++i)
+	{
+		Widgets[i]->mValuesPending = false;
+		Widgets[i]->scheduleUpdate();
+	}
+}
+
+
+/**
+ * Returns the needle angle for the current value. The angle is cached and
+ * only recomputed if the value or the scale of the needle changed.
+ */
+double QcNeedleItem::currentDegree()
+{
+	if (mDegreeRevision != revision())
+	{
+		mCurrentDegree = getDegFromValue(mCurrentValue);
+		mDegreeRevision = revision();
+	}
+	return mCurrentDegree;
+}
+
+double QcNeedleItem::value() const
+{
+	if (mModel)
+	{
+		return qBound(mMinValue, mModel->value(mModelChannel), mMaxValue);
+	}
+    return mCurrentValue;
+}
+
+
+void QcNeedleItem::setModel(QcGaugeModel* Model, int Channel)
+{
+	QcGaugeModel* OldModel = mModel;
+	mModel = Model;
+	mModelChannel = Model ? Channel : -1;
+	if (OldModel && OldModel != Model)
+	{
+		// other needles of the widget may still be bound to the old model
+		bool Bound = false;
+		for (int i = 0; i < mGaugeWidget->mItems.size() && !Bound; ++i)
+		{
+			QcNeedleItem* Needle = dynamic_cast<QcNeedleItem*>(mGaugeWidget->mItems.at(i));
+			Bound = Needle && Needle != this && Needle->mModel == OldModel;
+		}
+		if (!Bound)
+		{
+			QObject::disconnect(OldModel, SIGNAL(changed()), mGaugeWidget,
+				SLOT(onModelChanged()));
+		}
+	}
+	if (Model)
+	{
+		QObject::connect(Model, SIGNAL(changed()), mGaugeWidget,
+			SLOT(onModelChanged()), Qt::UniqueConnection);
+	}
+	update();
+}
+
+
+QcGaugeModel* QcNeedleItem::model() const
+{
+	return mModel;
+}
+
+
+int QcNeedleItem::modelChannel() const
+{
+	return mModelChannel;
+}
+
+
+/**
+ * Takes over the current value of the bound model channel
+ */
+void QcNeedleItem::syncModelValue()
+{
+	if (!mModel)
+	{
+		return;
+	}
+
+	double Value = qBound(mMinValue, mModel->value(mModelChannel), mMaxValue);
+	if (Value != mCurrentValue)
+	{
+		mCurrentValue = Value;
+		mDegreeRevision = 0;
+		mLabelDirty = true;
+		if (mHold)
+		{
+			mHold->addSample(Value);
+		}
+		extendEnvelope(Value);
+		if (mAlarmBand)
+		{
+			mAlarmBand->evaluateAlarms(&Value, 1);
+		}
+	}
+}
+
+
+/**
+ * Widens the envelope of the next paint to Value and returns true, if the
+ * envelope changed
+ */
+bool QcNeedleItem::extendEnvelope(double Value)
+{
+	if (!mEnvelope)
+	{
+		return false;
+	}
+	if (Value < mEnvelopeMin)
+	{
+		mEnvelopeMin = Value;
+		return true;
+	}
+	if (Value > mEnvelopeMax)
+	{
+		mEnvelopeMax = Value;
+		return true;
+	}
+	return false;
+}
+
+
+void QcNeedleItem::setFilter(const QcSampleFilter& Filter)
+{
+	delete mFilter;
+	mFilter = (Filter.type() == QcSampleFilter::NoFilter)
+		? 0 : new QcSampleFilter(Filter);
+	if (mFilter)
+	{
+		mFilter->reset();
+	}
+}
+
+
+const QcSampleFilter* QcNeedleItem::filter() const
+{
+	return mFilter;
+}
+
+
+void QcNeedleItem::setAlarmBand(QcColorBand* Band)
+{
+	if (mAlarmBand == Band)
+	{
+		return;
+	}
+	if (mAlarmBand)
+	{
+		mAlarmBand->mAlarm->Needles.removeOne(this);
+	}
+	mAlarmBand = Band;
+	if (mAlarmBand)
+	{
+		mAlarmBand->alarm()->Needles.append(this);
+	}
+}
+
+
+QcColorBand* QcNeedleItem::alarmBand() const
+{
+	return mAlarmBand;
+}
+
+
+void QcNeedleItem::setEnvelope(bool Enable)
+{
+	mEnvelope = Enable;
+	mEnvelopeMin = mEnvelopeMax = mCurrentValue;
+	mFrameMin = mFrameMax = mCurrentValue;
+	update();
+}
+
+
+bool QcNeedleItem::envelope() const
+{
+	return mEnvelope;
+}
+
+
+void QcNeedleItem::setEnvelopeColor(const QColor& color)
+{
+	mEnvelopeBrush.setColor(color);
+	update();
+}
+
+
+/**
+ * Returns the hold state and creates it on the first call
+ */
+QcHoldTracker* QcNeedleItem::hold()
+{
+	if (!mHold)
+	{
+		mHold = new QcHoldTracker();
+	}
+	return mHold;
+}
+
+
+void QcNeedleItem::setPeakHold(bool Enable)
+{
+	hold()->PeakHold = Enable;
+	resetHold();
+}
+
+
+bool QcNeedleItem::peakHold() const
+{
+	return mHold && mHold->PeakHold;
+}
+
+
+void QcNeedleItem::setMinimumHold(bool Enable)
+{
+	hold()->MinimumHold = Enable;
+	resetHold();
+}
+
+
+bool QcNeedleItem::minimumHold() const
+{
+	return mHold && mHold->MinimumHold;
+}
+
+
+void QcNeedleItem::setHoldWindow(int Msecs, int Samples)
+{
+	hold()->WindowMsecs = qMax(Msecs, 0);
+	hold()->WindowSamples = qMax(Samples, 0);
+	mHold->expire();
+	update();
+}
+
+
+void QcNeedleItem::resetHold()
+{
+	if (!mHold)
+	{
+		return;
+	}
+	mHold->Peaks.clear();
+	mHold->Minimums.clear();
+	mHold->addSample(mCurrentValue);
+	update();
+}
+
+
+double QcNeedleItem::heldPeak() const
+{
+	return (mHold && mHold->PeakHold && !mHold->Peaks.isEmpty())
+		? mHold->Peaks.front() : mCurrentValue;
+}
+
+
+double QcNeedleItem::heldMinimum() const
+{
+	return (mHold && mHold->MinimumHold && !mHold->Minimums.isEmpty())
+		? mHold->Minimums.front() : mCurrentValue;
+}
+
+
+void QcNeedleItem::setHoldMarkerColor(const QColor& color)
+{
+	hold()->MarkerBrush.setColor(color);
+	update();
+}
+
+
+void QcNeedleItem::setValueRange(double minValue,double maxValue)
+{
+	QcScaleItem::setRange(minValue, maxValue);
+}
+
+void QcNeedleItem::setMinimumValue(double minValue)
+{
+	QcScaleItem::setMinimumValue(minValue);
+}
+
+
+void QcNeedleItem::setMaximumValue(double maxValue)
+{
+	QcScaleItem::setMaximumValue(maxValue);
+}
+
+void QcNeedleItem::setColor(const QColor &color)
+{
+    mBrush.setColor(color);
+    mGradientTable.clear();
+    update();
+}
+
+const QColor& QcNeedleItem::color() const
+{
+    return mBrush.color();
+}
+
+
+void QcNeedleItem::setBrush(const QBrush& Brush)
+{
+	mBrush = Brush;
+	mGradientTable.clear();
+	update();
+}
+
+const QBrush& QcNeedleItem::brush() const
+{
+	return mBrush;
+}
+
+void QcNeedleItem::setLabel(QcLabelItem *label)
+{
+    mLabel = label;
+    mLabelDirty = true;
+    mGaugeWidget->removeItem(label);
+    update();
+}
+
+QcLabelItem *QcNeedleItem::label() const
+{
+    return mLabel;
+}
+
+
+void QcNeedleItem::setNeedle(QcNeedleItem::NeedleType needleType)
+{
+    mNeedleType = needleType;
+    if (CompassNeedle == needleType)
+    {
+    	QLinearGradient grad;
+    	grad.setCoordinateMode(QGradient::ObjectBoundingMode);
+    	grad.setFinalStop(QPointF(0, 1));
+    	grad.setColorAt(0.0,Qt::red);
+        grad.setColorAt(0.49,Qt::red);
+        grad.setColorAt(0.5,Qt::blue);
+        grad.setColorAt(1,Qt::blue);
+        mBrush = QBrush(grad);
+        mGradientTable.clear();
+    }
+    mNeedlePolyRadius = -1;
+    mDropShadowImage = QImage();
+    update();
+}
+
+
+void QcNeedleItem::setCustomNeedle(const QVector<QPointF>& NeedlePoly)
+{
+	mNeedleType = CustomNeedle;
+	mCustomNeedlePoly = NeedlePoly;
+	mNeedlePolyRadius = -1;
+	mDropShadowImage = QImage();
+    update();
+}
+
+
+void QcNeedleItem::setThicknessFactor(float Value)
+{
+	mThicknessFactor = Value;
+	mNeedlePolyRadius = -1;
+	mDropShadowImage = QImage();
+	update();
+}
+
+
+QPolygonF QcNeedleItem::createDiamonNeedle(double r) const
+{
+    QVector<QPointF> tmpPoints;
+    tmpPoints.append(QPointF(0.0, 0.0));
+    tmpPoints.append(QPointF(-r/20.0 * mThicknessFactor, r/20.0));
+    tmpPoints.append(QPointF(0.0, r));
+    tmpPoints.append(QPointF(r/20.0 * mThicknessFactor, r/20.0));
+    return tmpPoints;
+}
+
+QPolygonF QcNeedleItem::createTriangleNeedle(double r) const
+{
+    QVector<QPointF> tmpPoints;
+    tmpPoints.append(QPointF(0.0, r));
+    tmpPoints.append(QPointF(-r/40 * mThicknessFactor, 0.0));
+    tmpPoints.append(QPointF(r/40 * mThicknessFactor,0.0));
+    return tmpPoints;
+}
+
+QPolygonF QcNeedleItem::createFeatherNeedle(double r) const
+{
+    QVector<QPointF> tmpPoints;
+    tmpPoints.append(QPointF(0.0, r));
+    tmpPoints.append(QPointF(-r/40.0 * mThicknessFactor, 0.0));
+    tmpPoints.append(QPointF(-r/15.0 * mThicknessFactor, -r/5.0));
+    tmpPoints.append(QPointF(r/15.0 * mThicknessFactor, -r/5));
+    tmpPoints.append(QPointF(r/40.0 * mThicknessFactor,0.0));
+    return tmpPoints;
+}
+
+QPolygonF QcNeedleItem::createAttitudeNeedle(double r) const
+{
+    QVector<QPointF> tmpPoints;
+    tmpPoints.append(QPointF(0.0, r));
+    tmpPoints.append(QPointF(-r/20.0, 0.85*r));
+    tmpPoints.append(QPointF(r/20.0,0.85*r));
+    return tmpPoints;
+}
+
+QPolygonF QcNeedleItem::createCompassNeedle(double r) const
+{
+    QVector<QPointF> tmpPoints;
+    tmpPoints.append(QPointF(0.0, r));
+    tmpPoints.append(QPointF(-r/15.0, 0.0));
+    tmpPoints.append(QPointF(0.0, -r));
+    tmpPoints.append(QPointF(r/15.0,0.0));
+    return tmpPoints;
+}
+
+
+QPolygonF QcNeedleItem::createCustomNeedle(double r) const
+{
+	QVector<QPointF> tmpPoints(mCustomNeedlePoly);
+	for (int i = 0; i < tmpPoints.size(); ++i)
+	{
+		tmpPoints[i] *= r;
+	}
+
+	return tmpPoints;
+}
+
+
+const QPolygonF& QcNeedleItem::needlePoly(double Radius)
+{
+	if (Radius != mNeedlePolyRadius)
+	{
+		mNeedlePoly = createNeedlePoly(Radius);
+		mNeedlePolyRect = mNeedlePoly.boundingRect();
+		mNeedlePolyRadius = Radius;
+	}
+	return mNeedlePoly;
+}
+
+
+QPolygonF QcNeedleItem::createNeedlePoly(double Radius) const
+{
+    switch (mNeedleType)
+    {
+    case QcNeedleItem::FeatherNeedle: return createFeatherNeedle(Radius);
+    case QcNeedleItem::DiamonNeedle: return createDiamonNeedle(Radius);
+    case QcNeedleItem::TriangleNeedle: return createTriangleNeedle(Radius);
+    case QcNeedleItem::AltitudeMeterNeedle: return createAttitudeNeedle(Radius);
+    case QcNeedleItem::CompassNeedle: return createCompassNeedle(Radius);
+    case QcNeedleItem::CustomNeedle: return createCustomNeedle(Radius);
+    default:
+        return createTriangleNeedle(Radius);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcNeedleProxy::QcNeedleProxy(QcNeedleItem* Needle)
+	: QObject(0),
+	  mNeedle(Needle)
+{
+
+}
+
+
+QcNeedleItem* QcNeedleProxy::needle() const
+{
+	return mNeedle;
+}
+
+
+void QcNeedleProxy::setValue(double value)
+{
+	mNeedle->setValue(value);
+}
+
+
+void QcNeedleProxy::setValueRange(double minValue, double maxValue)
+{
+	mNeedle->setValueRange(minValue, maxValue);
+}
+
+
+void QcNeedleProxy::setMinimumValue(double minValue)
+{
+	mNeedle->setMinimumValue(minValue);
+}
+
+
+void QcNeedleProxy::setMaximumValue(double maxValue)
+{
+	mNeedle->setMaximumValue(maxValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcValuesItem::QcValuesItem(QcGaugeWidget* ParentWidget) :
+    QcScaleItem(ParentWidget),
+    mStep(10),
+    mColor(Qt::black),
+    mScaleFactor(1),
+    mDecimals(1)
+{
+    mPosition = 70;
+}
+
+
+void QcValuesItem::prepareDraw(QPaintDevice* Device)
+{
+	QcScaleItem::prepareDraw(Device);
+	double PointSize = 0.08 * getRadius(adjustRect(99)) * mScaleFactor;
+	if (mFont.pointSizeF() != PointSize)
+	{
+		mFont.setPointSizeF(PointSize);
+	}
+}
+
+
+void QcValuesItem::draw(QPainter*painter)
+{
+    QRectF tmpRect = widgetRect();
+    double r = getRadius(adjustRect(99));
+    // after prepareDraw() the font already has the size and is not modified,
+    // so concurrent band painters only read it
+    double PointSize = 0.08 * r * mScaleFactor;
+    if (mFont.pointSizeF() != PointSize)
+    {
+    	mFont.setPointSizeF(PointSize);
+    }
+
+    painter->setFont(mFont);
+    painter->setPen(mColor);
+    for(double val = mMinValue;val<=mMaxValue;val+=mStep){
+        double deg = getDegFromValue(val);
+        QPointF pt = getPoint(deg,tmpRect);
+        QPainterPath path;
+        path.moveTo(pt);
+        path.lineTo(    tmpRect.center());
+        QString strVal = QString::number(val, 'f', mDecimals);
+        QFontMetrics fMetrics = painter->fontMetrics();
+        QSize sz = fMetrics.size( Qt::TextSingleLine, strVal );
+        QRectF txtRect(QPointF(0,0), sz );
+        QPointF textCenter = path.pointAtPercent(1.0-position()/100.0);
+        txtRect.moveCenter(textCenter);
+
+        painter->drawText( txtRect, Qt::TextSingleLine, strVal );
+    }
+}
+
+
+void QcValuesItem::setDecimals(int Value)
+{
+	mDecimals = Value;
+	invalidate();
+}
+
+void QcValuesItem::setStep(double step)
+{
+    mStep = step;
+    invalidate();
+}
+
+
+void QcValuesItem::setColor(const QColor& color)
+{
+    mColor = color;
+    invalidate();
+}
+
+void QcValuesItem::setFont(const QFont& font)
+{
+	mFont = font;
+	invalidate();
+}
+
+
+const QFont& QcValuesItem::font() const
+{
+	return mFont;
+}
+
+void QcValuesItem::setScaleFactor(float ScaleFactor)
+{
+	mScaleFactor = ScaleFactor;
+	invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Maximum number of bytes of the pre-rotated sprites of one dial
+ */
+static const qint64 MaxDialSpriteBytes = 32 * 1024 * 1024;
+
+
+QcRotatingDialItem::QcRotatingDialItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mValue(0),
+    mRotationStep(0),
+    mDialKey(0),
+    mSpriteClock(0)
+{
+    mPosition = 100;
+}
+
+
+QcRotatingDialItem::~QcRotatingDialItem()
+{
+	qDeleteAll(mDialItems);
+}
+
+
+bool QcRotatingDialItem::isDynamic() const
+{
+	return true;
+}
+
+
+QcDegreesItem* QcRotatingDialItem::addDegrees(double position)
+{
+    QcDegreesItem * item = new QcDegreesItem(mGaugeWidget);
+    addItem(item, position);
+    return item;
+}
+
+
+QcValuesItem* QcRotatingDialItem::addValues(double position)
+{
+    QcValuesItem * item = new QcValuesItem(mGaugeWidget);
+    addItem(item, position);
+    return item;
+}
+
+
+QcArcItem* QcRotatingDialItem::addArc(double position)
+{
+    QcArcItem * item = new QcArcItem(mGaugeWidget);
+    addItem(item, position);
+    return item;
+}
+
+
+QcColorBand* QcRotatingDialItem::addColorBand(double position)
+{
+    QcColorBand * item = new QcColorBand(mGaugeWidget);
+    addItem(item, position);
+    return item;
+}
+
+
+QcLabelItem* QcRotatingDialItem::addLabel(double position)
+{
+    QcLabelItem * item = new QcLabelItem(mGaugeWidget);
+    addItem(item, position);
+    return item;
+}
+
+
+void QcRotatingDialItem::addItem(QcItem* item, double position)
+{
+	item->setPosition(position);
+	mDialItems.append(item);
+	invalidate();
+}
+
+
+QList<QcItem*> QcRotatingDialItem::items() const
+{
+	return mDialItems;
+}
+
+
+void QcRotatingDialItem::setValue(double Value)
+{
+	// a quantized dial only changes if the value moves to another step
+	bool Changed = (mRotationStep > 0)
+		? qRound(Value / mRotationStep) != qRound(mValue / mRotationStep)
+		: Value != mValue;
+	mValue = Value;
+	if (Changed)
+	{
+		update();
+	}
+}
+
+
+double QcRotatingDialItem::value() const
+{
+	return mValue;
+}
+
+
+void QcRotatingDialItem::setRotationStep(double Step)
+{
+	mRotationStep = qMax(Step, 0.0);
+	mSprites.clear();
+	update();
+}
+
+
+double QcRotatingDialItem::rotationStep() const
+{
+	return mRotationStep;
+}
+
+
+/**
+ * Returns a key that changes whenever the dial or one of its items has
+ * been invalidated
+ */
+quint64 QcRotatingDialItem::contentKey() const
+{
+	quint64 Key = revision();
+	for (int i = 0; i < mDialItems.size(); ++i)
+	{
+		Key += mDialItems.at(i)->revision();
+	}
+	return Key;
+}
+
+
+/**
+ * Renders the items of the dial rotated counterclockwise by Angle degree
+ * around the gauge centre
+ */
+QImage QcRotatingDialItem::renderDial(double Angle)
+{
+	int Diameter = mGaugeWidget->diameter();
+	QImage Image(QSize(Diameter, Diameter), QImage::Format_ARGB32_Premultiplied);
+	Image.fill(Qt::transparent);
+	QPainter Painter(&Image);
+	Painter.setRenderHints(QPainter::Antialiasing);
+	if (Angle != 0)
+	{
+		QPointF Center = widgetRect().center();
+		Painter.translate(Center);
+		Painter.rotate(-Angle);
+		Painter.translate(-Center);
+	}
+	for (int i = 0; i < mDialItems.size(); ++i)
+	{
+		mDialItems.at(i)->draw(&Painter);
+	}
+	return Image;
+}
+
+
+void QcRotatingDialItem::draw(QPainter* painter)
+{
+	int Diameter = mGaugeWidget->diameter();
+	if (Diameter <= 0)
+	{
+		return;
+	}
+
+	quint64 Key = contentKey();
+	if (mDialImage.width() != Diameter || mDialKey != Key)
+	{
+		mSprites.clear();
+		mDialImage = renderDial(0);
+		mDialKey = Key;
+	}
+
+	if (mRotationStep > 0)
+	{
+		// the sprites are rendered from the items, not resampled from the
+		// dial image, so they are as sharp as the unrotated dial
+		double Angle = fmod(qRound(mValue / mRotationStep) * mRotationStep, 360.0);
+		if (Angle < 0)
+		{
+			Angle += 360;
+		}
+		qint64 Key = qRound64(Angle * 1000) % 360000;
+		QHash<qint64, Sprite>::iterator it = mSprites.find(Key);
+		if (it == mSprites.end())
+		{
+			evictSprite();
+			Sprite NewSprite;
+			NewSprite.Image = (Key == 0) ? mDialImage : renderDial(Angle);
+			it = mSprites.insert(Key, NewSprite);
+		}
+		it.value().LastUse = ++mSpriteClock;
+		painter->drawImage(QPointF(0, 0), it.value().Image);
+		return;
+	}
+
+	const QTransform Transform = painter->transform();
+	QPainter::RenderHints Hints = painter->renderHints();
+	QPointF Center = widgetRect().center();
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->translate(Center);
+	painter->rotate(-mValue);
+	painter->translate(-Center);
+	painter->drawImage(QPointF(0, 0), mDialImage);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+	painter->setRenderHints(Hints);
+	painter->setTransform(Transform);
+}
+
+
+/**
+ * Removes the least recently painted sprite if the sprites reached
+ * MaxDialSpriteBytes
+ */
+void QcRotatingDialItem::evictSprite()
+{
+	qint64 SpriteBytes = imageBytes(mDialImage);
+	int MaxSprites = qMax(qint64(2), MaxDialSpriteBytes / qMax(SpriteBytes, qint64(1)));
+	if (mSprites.size() < MaxSprites)
+	{
+		return;
+	}
+
+	QHash<qint64, Sprite>::iterator Oldest = mSprites.begin();
+	for (QHash<qint64, Sprite>::iterator it = mSprites.begin(); it != mSprites.end(); ++it)
+	{
+		if (it.value().LastUse < Oldest.value().LastUse)
+		{
+			Oldest = it;
+		}
+	}
+	mSprites.erase(Oldest);
+}
+
+
+void QcRotatingDialItem::releaseCache()
+{
+	QcItem::releaseCache();
+	mDialImage = QImage();
+	mSprites.clear();
+}
+
+
+qint64 QcRotatingDialItem::cacheSize() const
+{
+	qint64 Bytes = QcItem::cacheSize() + imageBytes(mDialImage);
+	QHash<qint64, Sprite>::const_iterator it = mSprites.constBegin();
+	for (; it != mSprites.constEnd(); ++it)
+	{
+		// sprite 0 shares the dial image
+		if (it.key() != 0)
+		{
+			Bytes += imageBytes(it.value().Image);
+		}
+	}
+	return Bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Maximum number of strip chunks a tape keeps rendered
+ */
+static const int MaxTapeChunks = 8;
+
+
+QcTapeItem::QcTapeItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mValue(0),
+    mVisibleSpan(100),
+    mMinValue(-std::numeric_limits<double>::max()),
+    mMaxValue(std::numeric_limits<double>::max()),
+    mStep(10),
+    mLabelStep(50),
+    mTapeWidth(40),
+    mDecimals(0),
+    mColor(Qt::white),
+    mBackgroundColor(Qt::transparent),
+    mIndexPen(QBrush(Qt::white), 2),
+    mExplicitFontSize(false),
+    mChunkRevision(0)
+{
+    mPosition = 100;
+}
+
+
+bool QcTapeItem::isDynamic() const
+{
+	return true;
+}
+
+
+void QcTapeItem::setValue(double Value)
+{
+	if (Value != mValue)
+	{
+		mValue = Value;
+		update();
+	}
+}
+
+
+double QcTapeItem::value() const
+{
+	return mValue;
+}
+
+
+void QcTapeItem::setVisibleSpan(double Span)
+{
+	if (Span <= 0)
+	{
+		throw (QcItem::InvalidValueRange);
+	}
+	mVisibleSpan = Span;
+	invalidate();
+}
+
+
+double QcTapeItem::visibleSpan() const
+{
+	return mVisibleSpan;
+}
+
+
+void QcTapeItem::setRange(double minValue, double maxValue)
+{
+	if (minValue > maxValue)
+	{
+		throw (QcItem::InvalidValueRange);
+	}
+	mMinValue = minValue;
+	mMaxValue = maxValue;
+	invalidate();
+}
+
+
+double QcTapeItem::minimumValue() const
+{
+	return mMinValue;
+}
+
+
+double QcTapeItem::maximumValue() const
+{
+	return mMaxValue;
+}
+
+
+void QcTapeItem::setStep(double step)
+{
+	if (step <= 0)
+	{
+		throw (QcItem::InvalidStep);
+	}
+	mStep = step;
+	invalidate();
+}
+
+
+void QcTapeItem::setLabelStep(double step)
+{
+	if (step < 0)
+	{
+		throw (QcItem::InvalidStep);
+	}
+	mLabelStep = step;
+	invalidate();
+}
+
+
+void QcTapeItem::setDecimals(int Value)
+{
+	mDecimals = Value;
+	invalidate();
+}
+
+
+void QcTapeItem::setColor(const QColor& color)
+{
+	mColor = color;
+	mIndexPen.setColor(color);
+	invalidate();
+}
+
+
+void QcTapeItem::setBackgroundColor(const QColor& color)
+{
+	mBackgroundColor = color;
+	invalidate();
+}
+
+
+void QcTapeItem::setFont(const QFont& font)
+{
+	mFont = font;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	mExplicitFontSize = (font.resolveMask() & QFont::SizeResolved) != 0;
+#else
+	mExplicitFontSize = (font.resolve() & QFont::SizeResolved) != 0;
+#endif
+	invalidate();
+}
+
+
+const QFont& QcTapeItem::font() const
+{
+	return mFont;
+}
+
+
+void QcTapeItem::setTapeWidth(double percentage)
+{
+	mTapeWidth = qBound(0.0, percentage, 100.0);
+	invalidate();
+}
+
+
+/**
+ * Returns the pixel aligned rect of the tape, centered in the item rect
+ */
+QRectF QcTapeItem::tapeRect() const
+{
+	QRectF Rect = itemRect();
+	double Width = Rect.width() * mTapeWidth / 100.0;
+	QRect Aligned(qRound(Rect.center().x() - Width / 2), qRound(Rect.top()),
+		qRound(Width), qRound(Rect.height()));
+	return QRectF(Aligned);
+}
+
+
+/**
+ * Renders the strip chunk that covers the values from Chunk * mVisibleSpan
+ * at the bottom to (Chunk + 1) * mVisibleSpan at the top.
+ * Ticks and labels close to the chunk borders are rendered into both
+ * neighbouring chunks, so the halves of a label that straddles a border
+ * join seamlessly.
+ */
+QImage QcTapeItem::renderChunk(int Chunk, int Width, int Height)
+{
+	QImage Image(QSize(Width, Height), QImage::Format_ARGB32_Premultiplied);
+	Image.fill(mBackgroundColor);
+	QPainter Painter(&Image);
+	Painter.setRenderHints(QPainter::Antialiasing);
+	Painter.setPen(mColor);
+	Painter.setFont(mStripFont);
+
+	double PixelsPerValue = Height / mVisibleSpan;
+	double Low = Chunk * mVisibleSpan;
+	double High = Low + mVisibleSpan;
+	double TextHeight = Painter.fontMetrics().height();
+	double Margin = TextHeight / PixelsPerValue;
+	double MajorLength = Width * 0.25;
+	double MinorLength = Width * 0.12;
+
+	// ticks are indexed by integer multiples of the step, so no rounding
+	// error accumulates far from zero
+	qint64 First = qint64(std::ceil((Low - Margin) / mStep));
+	qint64 Last = qint64(std::floor((High + Margin) / mStep));
+	for (qint64 i = First; i <= Last; ++i)
+	{
+		double Value = i * mStep;
+		if (Value < mMinValue || Value > mMaxValue)
+		{
+			continue;
+		}
+		double y = (High - Value) * PixelsPerValue;
+		bool Major = (mLabelStep > 0)
+			&& qAbs(Value - qRound64(Value / mLabelStep) * mLabelStep) < mStep * 1e-6;
+		Painter.drawLine(QPointF(0, y), QPointF(Major ? MajorLength : MinorLength, y));
+		if (Major)
+		{
+			QRectF TextRect(MajorLength * 1.4, y - TextHeight / 2,
+				Width - MajorLength * 1.4, TextHeight);
+			Painter.drawText(TextRect, Qt::AlignLeft | Qt::AlignVCenter,
+				QString::number(Value, 'f', mDecimals));
+		}
+	}
+	return Image;
+}
+
+
+void QcTapeItem::draw(QPainter* painter)
+{
+	QRectF Rect = tapeRect();
+	int Width = int(Rect.width());
+	int Height = int(Rect.height());
+	if (Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+
+	QSize ChunkSize(Width, Height);
+	if (mChunkSize != ChunkSize || mChunkRevision != revision())
+	{
+		mChunks.clear();
+		mChunkSize = ChunkSize;
+		mChunkRevision = revision();
+		// the font scales with the tape unless a size has been set
+		mStripFont = mFont;
+		if (!mExplicitFontSize)
+		{
+			mStripFont.setPointSizeF(Height * 0.04);
+		}
+	}
+
+	// The window shows the values from mValue - mVisibleSpan / 2 to
+	// mValue + mVisibleSpan / 2. Chunk k is shifted by whole chunk heights
+	// against chunk 0, so all chunks share one rounded offset.
+	double PixelsPerValue = Height / mVisibleSpan;
+	qint64 Offset = qRound64((mValue + mVisibleSpan / 2) * PixelsPerValue);
+	int FirstChunk = int(std::floor((mValue - mVisibleSpan / 2) / mVisibleSpan));
+	int LastChunk = int(std::floor((mValue + mVisibleSpan / 2) / mVisibleSpan));
+	if (mChunks.size() + LastChunk - FirstChunk >= MaxTapeChunks)
+	{
+		// drop the chunks farthest from the visible window
+		QHash<int, QImage>::iterator it = mChunks.begin();
+		while (it != mChunks.end())
+		{
+			if (it.key() < FirstChunk - 1 || it.key() > LastChunk + 1)
+			{
+				it = mChunks.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	int Top = int(Rect.top());
+	for (int Chunk = FirstChunk; Chunk <= LastChunk; ++Chunk)
+	{
+		QHash<int, QImage>::iterator it = mChunks.find(Chunk);
+		if (it == mChunks.end())
+		{
+			it = mChunks.insert(Chunk, renderChunk(Chunk, Width, Height));
+		}
+
+		// window line of the top chunk row
+		int ChunkTop = int(Offset - qint64(Chunk + 1) * Height);
+		int SourceTop = qMax(0, -ChunkTop);
+		int SourceBottom = qMin(Height, Height - ChunkTop);
+		if (SourceBottom > SourceTop)
+		{
+			painter->drawImage(QPoint(int(Rect.left()), Top + ChunkTop + SourceTop),
+				it.value(), QRect(0, SourceTop, Width, SourceBottom - SourceTop));
+		}
+	}
+
+	painter->setPen(mIndexPen);
+	double Center = Rect.center().y();
+	painter->drawLine(QPointF(Rect.left(), Center), QPointF(Rect.right(), Center));
+}
+
+
+void QcTapeItem::releaseCache()
+{
+	QcItem::releaseCache();
+	mChunks.clear();
+}
+
+
+qint64 QcTapeItem::cacheSize() const
+{
+	qint64 Bytes = QcItem::cacheSize();
+	QHash<int, QImage>::const_iterator it = mChunks.constBegin();
+	for (; it != mChunks.constEnd(); ++it)
+	{
+		Bytes += imageBytes(it.value());
+	}
+	return Bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcHistoryItem::QcHistoryItem(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mSamples(2048),
+    mHead(0),
+    mCount(0),
+    mTimeSpan(10),
+    mMinValue(0),
+    mMaxValue(100),
+    mColor(Qt::darkBlue),
+    mTraceRect(0.25, 0.6, 0.5, 0.2),
+    mColumnTime(1),
+    mLastColumn(0),
+    mTraceRevision(0),
+    mNewSamples(false)
+{
+    mPosition = 100;
+    mClock.start();
+}
+
+
+bool QcHistoryItem::isDynamic() const
+{
+	return true;
+}
+
+
+void QcHistoryItem::addSample(double Value)
+{
+	int Capacity = mSamples.size();
+	Sample& Slot = mSamples[(mHead + mCount) % Capacity];
+	Slot.Time = currentTime();
+	Slot.Value = Value;
+	if (mCount < Capacity)
+	{
+		mCount++;
+	}
+	else
+	{
+		mHead = (mHead + 1) % Capacity;
+	}
+	mNewSamples = true;
+	update();
+}
+
+
+void QcHistoryItem::clear()
+{
+	mHead = 0;
+	mCount = 0;
+	invalidate();
+}
+
+
+void QcHistoryItem::setCapacity(int Capacity)
+{
+	mSamples.resize(qMax(Capacity, 1));
+	clear();
+}
+
+
+int QcHistoryItem::capacity() const
+{
+	return mSamples.size();
+}
+
+
+void QcHistoryItem::setTimeSpan(double Seconds)
+{
+	if (Seconds <= 0)
+	{
+		throw (QcItem::InvalidValueRange);
+	}
+	mTimeSpan = Seconds;
+	invalidate();
+}
+
+
+double QcHistoryItem::timeSpan() const
+{
+	return mTimeSpan;
+}
+
+
+void QcHistoryItem::setRange(double minValue, double maxValue)
+{
+	if (minValue >= maxValue)
+	{
+		throw (QcItem::InvalidValueRange);
+	}
+	mMinValue = minValue;
+	mMaxValue = maxValue;
+	invalidate();
+}
+
+
+void QcHistoryItem::setColor(const QColor& color)
+{
+	mColor = color;
+	invalidate();
+}
+
+
+void QcHistoryItem::setTraceRect(const QRectF& Rect)
+{
+	mTraceRect = Rect;
+	invalidate();
+}
+
+
+qint64 QcHistoryItem::currentTime() const
+{
+	return mClock.elapsed();
+}
+
+
+/**
+ * Returns the sample with the given age order, 0 is the oldest sample
+ */
+const QcHistoryItem::Sample& QcHistoryItem::sample(int Index) const
+{
+	return mSamples.at((mHead + Index) % mSamples.size());
+}
+
+
+/**
+ * Returns the absolute pixel column of the given sample time
+ */
+qint64 QcHistoryItem::column(qint64 Time) const
+{
+	return qint64(std::floor(Time / mColumnTime));
+}
+
+
+/**
+ * Returns the pixel aligned rect of the trace in widget coordinates
+ */
+QRect QcHistoryItem::traceRect() const
+{
+	QRectF Rect = itemRect();
+	return QRect(qRound(Rect.left() + mTraceRect.left() * Rect.width()),
+		qRound(Rect.top() + mTraceRect.top() * Rect.height()),
+		qRound(mTraceRect.width() * Rect.width()),
+		qRound(mTraceRect.height() * Rect.height()));
+}
+
+
+/**
+ * Moves the trace Columns pixels to the left. The columns that become
+ * free at the right edge are not cleared.
+ */
+void QcHistoryItem::scrollTrace(int Columns)
+{
+	int Width = mTraceImage.width();
+	for (int y = 0; y < mTraceImage.height(); ++y)
+	{
+		uint* Line = reinterpret_cast<uint*>(mTraceImage.scanLine(y));
+		memmove(Line, Line + Columns, (Width - Columns) * sizeof(uint));
+	}
+}
+
+
+/**
+ * Clears and redraws the columns from FirstColumn to LastColumn from the
+ * samples in the ring buffer. Each column spans the minimum and maximum of
+ * its samples and of the last sample before it, so the trace stays
+ * connected.
+ */
+void QcHistoryItem::drawColumns(qint64 FirstColumn, qint64 LastColumn)
+{
+	int Width = mTraceImage.width();
+	int Left = qMax(0, int(Width - 1 - (mLastColumn - FirstColumn)));
+	int Right = qMin(Width - 1, int(Width - 1 - (mLastColumn - LastColumn)));
+	if (Left > Right)
+	{
+		return;
+	}
+	for (int y = 0; y < mTraceImage.height(); ++y)
+	{
+		uint* Line = reinterpret_cast<uint*>(mTraceImage.scanLine(y));
+		std::fill(Line + Left, Line + Right + 1, 0u);
+	}
+
+	// walk back from the newest sample to the first one in the range
+	int i = mCount;
+	while (i > 0 && column(sample(i - 1).Time) >= FirstColumn)
+	{
+		--i;
+	}
+
+	bool HasPrevious = (i > 0);
+	double Previous = HasPrevious ? sample(i - 1).Value : 0;
+	qint64 Column = 0;
+	double Min = 0;
+	double Max = 0;
+	bool Open = false;
+	for (; i < mCount; ++i)
+	{
+		const Sample& S = sample(i);
+		qint64 SampleColumn = column(S.Time);
+		if (SampleColumn > LastColumn)
+		{
+			break;
+		}
+		if (!Open || SampleColumn != Column)
+		{
+			if (Open)
+			{
+				plotColumn(Column, Min, Max);
+			}
+			Column = SampleColumn;
+			Min = Max = HasPrevious ? Previous : S.Value;
+			Open = true;
+		}
+		Min = qMin(Min, S.Value);
+		Max = qMax(Max, S.Value);
+		Previous = S.Value;
+		HasPrevious = true;
+	}
+	if (Open)
+	{
+		plotColumn(Column, Min, Max);
+	}
+}
+
+
+/**
+ * Fills the pixels of one column from Min to Max
+ */
+void QcHistoryItem::plotColumn(qint64 Column, double Min, double Max)
+{
+	int Width = mTraceImage.width();
+	int Height = mTraceImage.height();
+	qint64 x = Width - 1 - (mLastColumn - Column);
+	if (x < 0 || x >= Width)
+	{
+		return;
+	}
+
+	double Scale = (Height - 1) / (mMaxValue - mMinValue);
+	int Top = qBound(0, qRound((mMaxValue - Max) * Scale), Height - 1);
+	int Bottom = qBound(0, qRound((mMaxValue - Min) * Scale), Height - 1);
+	uint Pixel = qPremultiply(mColor.rgba());
+	for (int y = Top; y <= Bottom; ++y)
+	{
+		reinterpret_cast<uint*>(mTraceImage.scanLine(y))[x] = Pixel;
+	}
+}
+
+
+void QcHistoryItem::draw(QPainter* painter)
+{
+	QRect Rect = traceRect();
+	if (Rect.width() <= 0 || Rect.height() <= 0)
+	{
+		return;
+	}
+
+	if (mTraceImage.size() != Rect.size() || mTraceRevision != revision())
+	{
+		if (mTraceImage.size() != Rect.size())
+		{
+			mTraceImage = QImage(Rect.size(), QImage::Format_ARGB32_Premultiplied);
+		}
+		mTraceRevision = revision();
+		mColumnTime = mTimeSpan * 1000.0 / Rect.width();
+		mLastColumn = column(currentTime());
+		mTraceImage.fill(Qt::transparent);
+		drawColumns(mLastColumn - Rect.width() + 1, mLastColumn);
+		mNewSamples = false;
+	}
+	else
+	{
+		qint64 Current = column(currentTime());
+		qint64 Shift = Current - mLastColumn;
+		if (Shift > 0 || mNewSamples)
+		{
+			// the column at the old right edge may have got more samples
+			qint64 FirstColumn = mLastColumn;
+			if (Shift >= Rect.width())
+			{
+				FirstColumn = Current - Rect.width() + 1;
+			}
+			else if (Shift > 0)
+			{
+				scrollTrace(int(Shift));
+			}
+			mLastColumn = Current;
+			drawColumns(FirstColumn, Current);
+			mNewSamples = false;
+		}
+	}
+
+	painter->drawImage(Rect.topLeft(), mTraceImage);
+
+	// keep the trace scrolling while the newest sample is visible, even if
+	// no new samples arrive
+	if (mCount > 0 && column(sample(mCount - 1).Time) > mLastColumn - Rect.width())
+	{
+		double NextColumnTime = (mLastColumn + 1) * mColumnTime;
+		updateAfter(qMax(1, int(ceil(NextColumnTime - currentTime()))));
+	}
+}
+
+
+void QcHistoryItem::releaseCache()
+{
+	QcItem::releaseCache();
+	mTraceImage = QImage();
+}
+
+
+qint64 QcHistoryItem::cacheSize() const
+{
+	return QcItem::cacheSize() + imageBytes(mTraceImage);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcAltitudeMeter::QcAltitudeMeter(QcGaugeWidget* ParentWidget) :
+    QcItem(ParentWidget),
+    mRoll(0),
+    mPitch(0)
+{
+
+}
+
+void QcAltitudeMeter::setCurrentPitch(double pitch)
+{
+    mPitch=-pitch;
+    invalidate();
+}
+
+void QcAltitudeMeter::setCurrentRoll(double roll)
+{
+    mRoll = roll;
+    invalidate();
+}
+
+QPointF QcAltitudeMeter::intersection(double r, const QPointF &pitchPoint, const QPointF &pt) const
+{
+    // refrence it to zero
+
+    Q_UNUSED(r)
+    double a = (pitchPoint.y()-pt.y())/(pitchPoint.x()-pt.x());
+    double b = pt.y()-a*pt.x();
+    return QPointF(0,a*0+b);
+}
+
+double QcAltitudeMeter::startAngle(const QRectF& tmpRect) const
+{
+    double r = getRadius(tmpRect);
+    QPointF pt1 = getPoint(mRoll,tmpRect);
+    pt1.setY(pt1.y()-mPitchOffset);
+    QPointF pitchPoint = QPointF(tmpRect.center().x(),tmpRect.center().y()-mPitchOffset);
+
+
+    ///////////////////////////////////////
+    QPainterPath path1;
+    path1.moveTo(pitchPoint);
+    path1.lineTo(intersection(r,pitchPoint,pt1)+QPointF(0,5));
+    path1.lineTo(intersection(r,pitchPoint,pt1)+QPointF(0,-5));
+
+    QPainterPath path2;
+    path2.addEllipse(tmpRect);
+
+    QPointF p = path1.intersected(path2).pointAtPercent(.5);
+    return getAngle(p,tmpRect);
+}
+
+void QcAltitudeMeter::draw(QPainter *painter)
+{
+    QRectF tmpRect = itemRect();
+    double r = getRadius(tmpRect);
+    if(mPitch<0)
+        mPitchOffset = 0.0135*r*mPitch;
+    else
+        mPitchOffset = 0.015*r*mPitch;
+
+    painter->setPen(Qt::NoPen);
+    drawUpperEllipse(painter,tmpRect);
+    drawLowerEllipse(painter,tmpRect);
+
+    // Steps
+
+    drawPitchSteps(painter,tmpRect);
+    drawHandle(painter);
+
+    drawDegrees(painter);
+}
+
+void QcAltitudeMeter::drawDegrees(QPainter *painter)
+{
+    QRectF tmpRect = itemRect();
+    double r = getRadius(tmpRect);
+    QPen pen;
+
+    pen.setColor(Qt::white);
+    painter->setPen(pen);
+    for(int deg = 60;deg<=120;deg+=10){
+        if(deg == 90)
+            continue;
+        drawDegree(painter,tmpRect,deg);
+    }
+
+    pen.setWidthF(r/30.0);
+    painter->setPen(pen);
+    drawDegree(painter,tmpRect,0);
+    drawDegree(painter,tmpRect,90);
+    drawDegree(painter,tmpRect,180);
+    drawDegree(painter,tmpRect,30);
+    drawDegree(painter,tmpRect,150);
+}
+
+
+void QcAltitudeMeter::drawDegree(QPainter * painter, const QRectF& tmpRect,double deg)
+{
+    QPointF pt1 = getPoint(deg,tmpRect);
+    QPointF pt2 = tmpRect.center();
+    QPainterPath path;
+    path.moveTo(pt1);
+    path.lineTo(pt2);
+    QPointF pt = path.pointAtPercent(0.1);
+    painter->drawLine(pt1,pt);
+}
+
+
+void QcAltitudeMeter::drawUpperEllipse(QPainter *painter, const QRectF &tmpRect)
+{
+
+    QLinearGradient radialGrad1(tmpRect.topLeft(),tmpRect.bottomRight());
+    QColor clr1 = Qt::blue;
+    clr1.setAlphaF(0.5);
+    QColor clr2 = Qt::darkBlue;
+    clr2.setAlphaF(0.5);
+    radialGrad1.setColorAt(0, clr1);
+    radialGrad1.setColorAt(.8, clr2);
+
+
+    double offset = startAngle(tmpRect);
+    double startAngle = 180-offset;
+    double endAngle = offset-2*mRoll;
+    double span =endAngle-startAngle;
+
+    painter->setBrush(radialGrad1);
+    painter->drawChord(tmpRect,16*startAngle,16*span);
+
+}
+
+
+void QcAltitudeMeter::drawLowerEllipse(QPainter *painter, const QRectF &tmpRect)
+{
+    QLinearGradient radialGrad2(tmpRect.topLeft(),tmpRect.bottomRight());
+    QColor clr1 = QColor(139,119,118);
+    QColor clr2 = QColor(139,119,101);
+    radialGrad2.setColorAt(0, clr1);
+    radialGrad2.setColorAt(.8, clr2);
+
+    double offset = startAngle(tmpRect);
+    double startAngle = 180+offset;
+    double endAngle = offset-2*mRoll;
+    double span =endAngle+startAngle;
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(radialGrad2);
+    painter->drawChord(tmpRect,-16*startAngle,16*span);
+
+}
+
+void QcAltitudeMeter::drawPitchSteps(QPainter *painter, const QRectF &tmpRect)
+{
+    double r = getRadius(tmpRect);
+    QPointF center = tmpRect.center();
+    painter->save();
+    painter->translate(center.x(),center.y()-mPitchOffset);
+    painter->rotate(mRoll);
+    QPen pen;
+    pen.setColor(Qt::white);
+    pen.setWidthF(r/40.0);
+
+    painter->setPen(pen);
+    for (int i = -30;i<=30;i+=10){
+        QPointF pt1;
+        pt1.setX(-0.01*r*abs(i));
+        pt1.setY(r/70.0*i);
+        QPointF pt2;
+        pt2.setX(0.01*r*abs(i));
+        pt2.setY(r/70.0*i);
+        painter->drawLine(pt1,pt2);
+
+        if(i==0)
+            continue;
+
+        // draw value
+        QFont font("Meiryo UI",0, QFont::Bold);
+        font.setPointSizeF(0.08*r);
+        painter->setFont(font);
+        QString strVal = QString::number(abs(i));
+        QFontMetrics fMetrics = painter->fontMetrics();
+        QSize sz = fMetrics.size( Qt::TextSingleLine, strVal );
+        QRectF leftTxtRect(QPointF(0,0), sz );
+        QRectF rightTxtRect(QPointF(0,0), sz );
+        leftTxtRect.moveCenter(pt1-QPointF(0.1*r,0));
+        rightTxtRect.moveCenter(pt2+QPointF(0.1*r,0));
+        painter->drawText( leftTxtRect, Qt::TextSingleLine, strVal );
+        painter->drawText( rightTxtRect, Qt::TextSingleLine, strVal );
+    }
+    painter->restore();
+}
+
+void QcAltitudeMeter::drawHandle(QPainter *painter)
+{
+    QRectF tmpRct = adjustRect(15);
+    double r = getRadius(tmpRct);
+    QPen pen;
+    pen.setColor(Qt::gray);
+    pen.setWidthF(0.25*r);
+    painter->setPen(pen);
+    painter->drawArc(tmpRct,0,-16*180);
+
+    QPointF center = tmpRct.center();
+    QPointF leftPt1 = center;
+    QPointF leftPt2 = center;
+    QPointF rightPt1 = center;
+    QPointF rightPt2 = center;
+    leftPt1.setX(center.x()-2*r);
+    leftPt2.setX(center.x()-r);
+    rightPt1.setX(center.x()+2*r);
+    rightPt2.setX(center.x()+r);
+    painter->drawLine(leftPt1,leftPt2);
+    painter->drawLine(rightPt1,rightPt2);
+    painter->drawEllipse(adjustRect(2));
+
+    //
+    QPointF pt1 = center;
+    QPointF pt2 = center;
+    // to get the real 100 % radius, without recomputing
+    pt1.setY(center.y()+r);
+    pt2.setY(center.y()+4*r);
+    pen.setColor(Qt::gray);
+    painter->setPen(pen);
+    painter->drawLine(pt1,pt2);
+
+    // trapezium
+    painter->setPen(Qt::gray);
+    painter->setBrush(Qt::gray);
+    QPolygonF trapPoly;
+    QPointF tmpPt = center;
+    tmpPt.setX(center.x()-r);
+    tmpPt.setY(center.y()+4*r);
+    trapPoly.append(tmpPt);
+    tmpRct = itemRect();
+    trapPoly.append(getPoint(290,tmpRct));
+    trapPoly.append(getPoint(250,tmpRct));
+    tmpPt = center;
     tmpPt.setX(center.x()+r);
     tmpPt.setY(center.y()+4*r);
     trapPoly.append(tmpPt);
@@ -1609,3 +5955,707 @@ void QcAltitudeMeter::drawHandle(QPainter *painter)
     painter->drawChord(tmpRct,-16*70,-16*40);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcGaugeModel::QcGaugeModel(QObject* parent) :
+	QObject(parent),
+	mRevision(0)
+{
+
+}
+
+
+QcGaugeModel::~QcGaugeModel()
+{
+
+}
+
+
+int QcGaugeModel::addChannel(double minValue, double maxValue)
+{
+	if (!(minValue < maxValue))
+		throw (QcItem::InvalidValueRange);
+	mValues.append(minValue);
+	mMinValues.append(minValue);
+	mMaxValues.append(maxValue);
+	// the first sample replaces both extremes
+	mPeaks.append(minValue);
+	mTroughs.append(maxValue);
+	mLowLimits.append(-std::numeric_limits<double>::infinity());
+	mHighLimits.append(std::numeric_limits<double>::infinity());
+	mAlarmStates.append(NoAlarm);
+	return mValues.size() - 1;
+}
+
+
+int QcGaugeModel::channelCount() const
+{
+	return mValues.size();
+}
+
+
+void QcGaugeModel::setRange(int Channel, double minValue, double maxValue)
+{
+	if (!(minValue < maxValue))
+		throw (QcItem::InvalidValueRange);
+	mMinValues[Channel] = minValue;
+	mMaxValues[Channel] = maxValue;
+	ingest(Channel, mValues.at(Channel));
+	mRevision++;
+	emit changed();
+}
+
+
+double QcGaugeModel::minimumValue(int Channel) const
+{
+	return mMinValues.at(Channel);
+}
+
+
+double QcGaugeModel::maximumValue(int Channel) const
+{
+	return mMaxValues.at(Channel);
+}
+
+
+void QcGaugeModel::ingest(int Channel, double Value)
+{
+	Value = qBound(mMinValues.at(Channel), Value, mMaxValues.at(Channel));
+	mValues[Channel] = Value;
+	if (Value > mPeaks.at(Channel))
+	{
+		mPeaks[Channel] = Value;
+	}
+	if (Value < mTroughs.at(Channel))
+	{
+		mTroughs[Channel] = Value;
+	}
+
+	int State = NoAlarm;
+	if (Value < mLowLimits.at(Channel))
+	{
+		State = LowAlarm;
+	}
+	else if (Value > mHighLimits.at(Channel))
+	{
+		State = HighAlarm;
+	}
+
+	if (State != mAlarmStates.at(Channel))
+	{
+		mAlarmStates[Channel] = State;
+		emit alarmChanged(Channel, State);
+	}
+}
+
+
+void QcGaugeModel::setValue(int Channel, double Value)
+{
+	ingest(Channel, Value);
+	mRevision++;
+	emit changed();
+}
+
+
+void QcGaugeModel::setValues(const int* Channels, const double* Values, int Count)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < Count; ++i)
+	{
+		ingest(Channels[i], Values[i]);
+	}
+	mRevision++;
+	emit changed();
+}
+
+
+double QcGaugeModel::value(int Channel) const
+{
+	return mValues.at(Channel);
+}
+
+
+double QcGaugeModel::peak(int Channel) const
+{
+	return mPeaks.at(Channel);
+}
+
+
+double QcGaugeModel::trough(int Channel) const
+{
+	return mTroughs.at(Channel);
+}
+
+
+void QcGaugeModel::resetPeaks(int Channel)
+{
+	mPeaks[Channel] = mValues.at(Channel);
+	mTroughs[Channel] = mValues.at(Channel);
+	mRevision++;
+	emit changed();
+}
+
+
+void QcGaugeModel::setAlarmLimits(int Channel, double Low, double High)
+{
+	mLowLimits[Channel] = Low;
+	mHighLimits[Channel] = High;
+	ingest(Channel, mValues.at(Channel));
+	mRevision++;
+	emit changed();
+}
+
+
+QcGaugeModel::AlarmState QcGaugeModel::alarmState(int Channel) const
+{
+	return static_cast<AlarmState>(mAlarmStates.at(Channel));
+}
+
+
+quint64 QcGaugeModel::revision() const
+{
+	return mRevision;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A changed gauge that is waiting for a repaint by the dashboard scheduler
+ */
+struct QcRepaintCandidate
+{
+	QcGaugeWidget* Gauge;
+	double Score; ///< priority weighted staleness
+	double Cost; ///< estimated paint time in ms
+	bool Overdue; ///< must be painted to keep the staleness bound
+};
+
+
+static bool repaintCandidateLessThan(const QcRepaintCandidate& a,
+	const QcRepaintCandidate& b)
+{
+	if (a.Overdue != b.Overdue)
+	{
+		return a.Overdue;
+	}
+	return a.Score > b.Score;
+}
+
+
+QcDashboardScheduler::QcDashboardScheduler(QObject* parent) :
+	QObject(parent),
+	mFrameRate(60),
+	mFrameBudget(8),
+	mProgressiveRendering(false),
+	mAverageRegenTime(2),
+	mTimeToFirstFrame(-1),
+	mTimeToAllGaugesRendered(-1),
+	mFramePaintTime(0),
+	mOverBudgetFrames(0),
+	mUnderBudgetFrames(0)
+{
+
+}
+
+
+QcDashboardScheduler::~QcDashboardScheduler()
+{
+	for (int i = 0; i < mGauges.size(); ++i)
+	{
+		mGauges.at(i)->mScheduler = 0;
+		mGauges.at(i)->update();
+	}
+}
+
+
+void QcDashboardScheduler::addGauge(QcGaugeWidget* Gauge)
+{
+	if (Gauge->mScheduler == this)
+	{
+		return;
+	}
+	if (Gauge->mScheduler)
+	{
+		Gauge->mScheduler->removeGauge(Gauge);
+	}
+	Gauge->mScheduler = this;
+	mGauges.append(Gauge);
+}
+
+
+void QcDashboardScheduler::removeGauge(QcGaugeWidget* Gauge)
+{
+	if (Gauge->mScheduler != this)
+	{
+		return;
+	}
+	Gauge->mScheduler = 0;
+	mGauges.removeAll(Gauge);
+	mDeferredGauges.removeAll(Gauge);
+	if (Gauge->mSchedulerDirty)
+	{
+		Gauge->update();
+	}
+}
+
+
+QList<QcGaugeWidget*> QcDashboardScheduler::gauges() const
+{
+	return mGauges;
+}
+
+
+void QcDashboardScheduler::setFrameRate(double Rate)
+{
+	if (!(Rate > 0))
+		throw (QcItem::InvalidValueRange);
+	mFrameRate = Rate;
+	if (mFrameTimer.isActive())
+	{
+		start();
+	}
+}
+
+
+double QcDashboardScheduler::frameRate() const
+{
+	return mFrameRate;
+}
+
+
+void QcDashboardScheduler::setFrameBudget(double Milliseconds)
+{
+	mFrameBudget = Milliseconds;
+}
+
+
+double QcDashboardScheduler::frameBudget() const
+{
+	return mFrameBudget;
+}
+
+
+QList<QcGaugeWidget*> QcDashboardScheduler::deferredGauges() const
+{
+	return mDeferredGauges;
+}
+
+
+void QcDashboardScheduler::setProgressiveRendering(bool Enabled)
+{
+	mProgressiveRendering = Enabled;
+}
+
+
+bool QcDashboardScheduler::progressiveRendering() const
+{
+	return mProgressiveRendering;
+}
+
+
+qint64 QcDashboardScheduler::timeToFirstFrame() const
+{
+	return mTimeToFirstFrame;
+}
+
+
+qint64 QcDashboardScheduler::timeToAllGaugesRendered() const
+{
+	return mTimeToAllGaugesRendered;
+}
+
+
+void QcDashboardScheduler::start()
+{
+	mStartupTimer.start();
+	mTimeToFirstFrame = -1;
+	mTimeToAllGaugesRendered = -1;
+	mFrameClock.invalidate();
+	mFrameTimer.start(qRound(1000.0 / mFrameRate), Qt::PreciseTimer, this);
+}
+
+
+void QcDashboardScheduler::stop()
+{
+	mFrameTimer.stop();
+}
+
+
+bool QcDashboardScheduler::isActive() const
+{
+	return mFrameTimer.isActive();
+}
+
+
+void QcDashboardScheduler::timerEvent(QTimerEvent* event)
+{
+	if (event->timerId() == mFrameTimer.timerId())
+	{
+		processFrame();
+	}
+	else
+	{
+		QObject::timerEvent(event);
+	}
+}
+
+
+/**
+ * Adds the paint time of a gauge to the load of the current frame and
+ * updates the startup measurements
+ */
+void QcDashboardScheduler::gaugePainted(QcGaugeWidget* Gauge, double PaintTime,
+	bool Regenerated)
+{
+	if (Regenerated)
+	{
+		mAverageRegenTime = mAverageRegenTime * 0.9 + PaintTime * 0.1;
+	}
+	else
+	{
+		mFramePaintTime += PaintTime;
+	}
+
+	if (!mStartupTimer.isValid())
+	{
+		return;
+	}
+	if (mTimeToFirstFrame < 0)
+	{
+		mTimeToFirstFrame = mStartupTimer.elapsed();
+	}
+	if (mTimeToAllGaugesRendered < 0 && !Gauge->mShowsPlaceholder)
+	{
+		bool AllRendered = true;
+		for (int i = 0; i < mGauges.size() && AllRendered; ++i)
+		{
+			const QcGaugeWidget* Other = mGauges.at(i);
+			AllRendered = !Other->isVisible() || !Other->mShowsPlaceholder;
+		}
+		if (AllRendered)
+		{
+			mTimeToAllGaugesRendered = mStartupTimer.elapsed();
+		}
+	}
+}
+
+
+/**
+ * Quality governor of all gauges with an enabled governor.
+ * The load of a frame is the paint time of all gauges since the previous
+ * frame and the delay of the frame against the frame rate, which grows if
+ * the event loop falls behind. Under load the gauges with the lowest
+ * priority are degraded first, with headroom the gauges with the highest
+ * priority are restored first.
+ */
+void QcDashboardScheduler::updateQualityLevels(double FrameDelay)
+{
+	static const int DegradeFrames = 10;
+	static const int RestoreFrames = 60;
+
+	double FrameInterval = 1000.0 / mFrameRate;
+	double Load = mFramePaintTime;
+	mFramePaintTime = 0;
+	bool OverBudget = Load > mFrameBudget || FrameDelay > FrameInterval;
+	bool UnderBudget = Load < mFrameBudget / 2 && FrameDelay < FrameInterval / 2;
+	mOverBudgetFrames = OverBudget ? mOverBudgetFrames + 1 : 0;
+	mUnderBudgetFrames = UnderBudget ? mUnderBudgetFrames + 1 : 0;
+
+	QcGaugeWidget* Selected = 0;
+	int Step = 0;
+	if (mOverBudgetFrames >= DegradeFrames)
+	{
+		mOverBudgetFrames = 0;
+		for (int i = 0; i < mGauges.size(); ++i)
+		{
+			QcGaugeWidget* Gauge = mGauges.at(i);
+			if (Gauge->mQualityGovernorEnabled
+			 && Gauge->mQualityLevel < QcGaugeWidget::NoLabelUpdate
+			 && (!Selected || Gauge->mPriority < Selected->mPriority))
+			{
+				Selected = Gauge;
+			}
+		}
+		Step = 1;
+	}
+	else if (mUnderBudgetFrames >= RestoreFrames)
+	{
+		mUnderBudgetFrames = 0;
+		for (int i = 0; i < mGauges.size(); ++i)
+		{
+			QcGaugeWidget* Gauge = mGauges.at(i);
+			if (Gauge->mQualityGovernorEnabled
+			 && Gauge->mQualityLevel > QcGaugeWidget::FullQuality
+			 && (!Selected || Gauge->mPriority > Selected->mPriority))
+			{
+				Selected = Gauge;
+			}
+		}
+		Step = -1;
+	}
+	if (!Selected)
+	{
+		return;
+	}
+
+	// all governed gauges with the selected priority change together
+	int Priority = Selected->mPriority;
+	for (int i = 0; i < mGauges.size(); ++i)
+	{
+		QcGaugeWidget* Gauge = mGauges.at(i);
+		int Level = Gauge->mQualityLevel + Step;
+		if (Gauge->mQualityGovernorEnabled && Gauge->mPriority == Priority
+		 && Level >= QcGaugeWidget::FullQuality && Level <= QcGaugeWidget::NoLabelUpdate)
+		{
+			Gauge->setQualityLevel(static_cast<QcGaugeWidget::QualityLevel>(Level));
+		}
+	}
+}
+
+
+void QcDashboardScheduler::processFrame()
+{
+	double FrameInterval = 1000.0 / mFrameRate;
+	double FrameDelay = mFrameClock.isValid()
+		? mFrameClock.nsecsElapsed() / 1000000.0 - FrameInterval : 0;
+	mFrameClock.start();
+	updateQualityLevels(FrameDelay);
+
+	mDeferredGauges.clear();
+	QVarLengthArray<QcRepaintCandidate, 256> Candidates;
+	for (int i = 0; i < mGauges.size(); ++i)
+	{
+		QcGaugeWidget* Gauge = mGauges.at(i);
+		if (!Gauge->mSchedulerDirty || !Gauge->isVisible())
+		{
+			continue;
+		}
+
+		if (Gauge->mLastPaintTimer.isValid()
+		 && Gauge->mLastPaintTimer.elapsed() < 1000.0 / Gauge->mMaximumRefreshRate)
+		{
+			mDeferredGauges.append(Gauge);
+			continue;
+		}
+
+		double Staleness = Gauge->mDirtyTimer.elapsed();
+		QcRepaintCandidate Candidate;
+		Candidate.Gauge = Gauge;
+		Candidate.Score = priorityWeight(Gauge->mPriority) * (Staleness + FrameInterval);
+		Candidate.Cost = Gauge->mUpdateBufferImages ? mAverageRegenTime
+			: Gauge->mAveragePaintTime;
+		// placeholders are revealed progressively and are not forced
+		Candidate.Overdue = !Gauge->mShowsPlaceholder
+			&& (Staleness + FrameInterval) >= 1000.0 / Gauge->mMinimumRefreshRate;
+		Candidates.append(Candidate);
+	}
+
+	std::sort(Candidates.begin(), Candidates.end(), repaintCandidateLessThan);
+
+	// The gauges are only marked for a repaint. Qt paints all of them in
+	// the next backing store sync and flushes the window once.
+	double Estimated = 0;
+	int Scheduled = 0;
+	for (int i = 0; i < Candidates.size(); ++i)
+	{
+		const QcRepaintCandidate& Candidate = Candidates.at(i);
+		// at least one gauge is painted per frame to guarantee progress
+		if (!Candidate.Overdue && Scheduled
+		 && Estimated + Candidate.Cost > mFrameBudget)
+		{
+			mDeferredGauges.append(Candidate.Gauge);
+			continue;
+		}
+
+		Estimated += Candidate.Cost;
+		Candidate.Gauge->mSchedulerRender = true;
+		Candidate.Gauge->update();
+		Scheduled++;
+	}
+
+	emit frameFinished(Scheduled, mDeferredGauges.size());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+QcCacheManager::QcCacheManager() :
+	mTotalUsage(0),
+	mBudget(0),
+	mLeastRecent(0),
+	mMostRecent(0),
+	mFrame(0),
+	mFrameOpen(false)
+{
+
+}
+
+
+QcCacheManager* QcCacheManager::instance()
+{
+	static QcCacheManager Instance;
+	return &Instance;
+}
+
+
+void QcCacheManager::setBudget(qint64 Bytes)
+{
+	mBudget = Bytes;
+	enforceBudget(0);
+}
+
+
+qint64 QcCacheManager::budget() const
+{
+	return mBudget;
+}
+
+
+qint64 QcCacheManager::totalUsage() const
+{
+	return mTotalUsage;
+}
+
+
+qint64 QcCacheManager::usage(const QcGaugeWidget* Widget) const
+{
+	return mUsage.value(const_cast<QcGaugeWidget*>(Widget), 0);
+}
+
+
+/**
+ * Records the cache size of a painted widget and moves it to the most
+ * recently used end of the LRU list
+ */
+void QcCacheManager::updateUsage(QcGaugeWidget* Widget, qint64 Bytes)
+{
+	QHash<QcGaugeWidget*, qint64>::iterator it = mUsage.find(Widget);
+	if (it != mUsage.end())
+	{
+		mTotalUsage -= it.value();
+		mUsage.erase(it);
+		unlink(Widget);
+	}
+	if (!Bytes)
+	{
+		return;
+	}
+
+	mUsage.insert(Widget, Bytes);
+	mTotalUsage += Bytes;
+	link(Widget, true);
+
+	// the frame ends when the event loop processes the next timer
+	if (!mFrameOpen)
+	{
+		mFrameOpen = true;
+		mFrame++;
+		QTimer::singleShot(0, &QcCacheManager::endFrame);
+	}
+	Widget->mCacheFrame = mFrame;
+	enforceBudget(Widget);
+}
+
+
+void QcCacheManager::removeWidget(QcGaugeWidget* Widget)
+{
+	QHash<QcGaugeWidget*, qint64>::iterator it = mUsage.find(Widget);
+	if (it != mUsage.end())
+	{
+		mTotalUsage -= it.value();
+		mUsage.erase(it);
+		unlink(Widget);
+	}
+}
+
+
+/**
+ * Moves a dormant widget to the front of the LRU list, so its caches are
+ * released before the caches of visible widgets
+ */
+void QcCacheManager::widgetHidden(QcGaugeWidget* Widget)
+{
+	if (mUsage.contains(Widget))
+	{
+		unlink(Widget);
+		link(Widget, false);
+	}
+}
+
+
+/**
+ * Inserts Widget at the most or least recently used end of the LRU list
+ */
+void QcCacheManager::link(QcGaugeWidget* Widget, bool MostRecent)
+{
+	if (MostRecent)
+	{
+		Widget->mCachePrev = mMostRecent;
+		Widget->mCacheNext = 0;
+		(mMostRecent ? mMostRecent->mCacheNext : mLeastRecent) = Widget;
+		mMostRecent = Widget;
+	}
+	else
+	{
+		Widget->mCachePrev = 0;
+		Widget->mCacheNext = mLeastRecent;
+		(mLeastRecent ? mLeastRecent->mCachePrev : mMostRecent) = Widget;
+		mLeastRecent = Widget;
+	}
+}
+
+
+void QcCacheManager::unlink(QcGaugeWidget* Widget)
+{
+	(Widget->mCachePrev ? Widget->mCachePrev->mCacheNext : mLeastRecent) = Widget->mCacheNext;
+	(Widget->mCacheNext ? Widget->mCacheNext->mCachePrev : mMostRecent) = Widget->mCachePrev;
+	Widget->mCachePrev = 0;
+	Widget->mCacheNext = 0;
+}
+
+
+bool QcCacheManager::paintedInCurrentFrame(const QcGaugeWidget* Widget) const
+{
+	return mFrameOpen && Widget->mCacheFrame == mFrame;
+}
+
+
+void QcCacheManager::endFrame()
+{
+	instance()->mFrameOpen = false;
+}
+
+
+/**
+ * Releases the caches of the least recently used widgets until the total
+ * usage fits into the budget. Dormant widgets are at the front of the LRU
+ * list and are evicted first. The caches of CurrentWidget and of all
+ * widgets painted in the current frame are never released, so the budget
+ * may be exceeded until the frame ends.
+ */
+void QcCacheManager::enforceBudget(QcGaugeWidget* CurrentWidget)
+{
+	QcGaugeWidget* Victim = mLeastRecent;
+	while (Victim && mBudget > 0 && mTotalUsage > mBudget)
+	{
+		QcGaugeWidget* Next = Victim->mCacheNext;
+		if (Victim != CurrentWidget && !paintedInCurrentFrame(Victim))
+		{
+			Victim->releaseCaches();
+		}
+		Victim = Next;
+	}
+}
+
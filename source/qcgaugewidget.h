@@ -33,6 +33,11 @@
 #include <QPen>
 #include <QRectF>
 #include <QImage>
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
 
 
 #if defined(QCGAUGE_COMPILE_LIBRARY)
@@ -51,9 +56,20 @@ class QcValuesItem;
 class QcArcItem;
 class QcColorBand;
 class QcNeedleItem;
+class QcNeedleProxy;
 class QcLabelItem;
 class QcGlassItem;
 class QcAltitudeMeter;
+class QcRotatingDialItem;
+class QcTapeItem;
+class QcHistoryItem;
+class QcGaugeModel;
+class QcHoldTracker;
+class QcSampleFilter;
+class QcAlarmState;
+class QcDashboardScheduler;
+class QcCacheManager;
+class QcItemStorage;
 
 /**
  * A circular gauge widget for instrumentation, and real time data measurement
@@ -65,7 +81,25 @@ class QCGAUGE_DECL QcGaugeWidget : public QWidget
 signals:
 	void sizeChanged(const QSize& Size);
 
+	/**
+	 * Emitted if the quality governor changed the quality level
+	 */
+	void qualityLevelChanged(int Level);
+
 public:
+    /**
+     * Rendering quality levels used by the quality governor.
+     * Each level includes the degradations of all lower levels.
+     */
+    enum QualityLevel
+    {
+    	FullQuality,         ///< everything is painted
+    	NoNeedleShadow,      ///< needle drop shadows are skipped
+    	NoNeedleAntialiasing,///< needles are painted without antialiasing
+    	ReducedUpdateRate,   ///< repaints are throttled to a lower rate
+    	NoLabelUpdate        ///< linked needle labels are not updated
+    };
+
     explicit QcGaugeWidget(QWidget *parent = 0);    
     virtual ~QcGaugeWidget();
 
@@ -78,6 +112,9 @@ public:
     QcLabelItem* addLabel(double position);
     QcGlassItem* addGlass(double position);
     QcAltitudeMeter* addAltitudeMeter(double position);
+    QcRotatingDialItem* addRotatingDial(double position);
+    QcTapeItem* addTape(double position);
+    QcHistoryItem* addHistory(double position);
     void addItem(QcItem* item, double position);
     bool removeItem(QcItem* item);
     QList <QcItem*> items();
@@ -89,21 +126,312 @@ public:
 
 public:
     virtual int heightForWidth(int w) const;
+    /**
+     * Invalidates the cached images of all items and rebuilds both layers
+     * on the next paint
+     */
     void invalidateBufferImages();
 
+    /**
+     * Invalidates the given item only.
+     * The cached image of the item is rebuilt on the next paint and the
+     * layer that contains the item is recomposited from the item caches.
+     */
+    void invalidateItem(QcItem* Item);
+
+    /**
+     * Starts a batch update.
+     * Until the matching endUpdate() call, invalidations are only collected
+     * and no repaint is requested. Calls may be nested. Use QcGaugeUpdateLocker
+     * for an exception safe scope.
+     */
+    void beginUpdate();
+
+    /**
+     * Ends a batch update. If something changed inside the batch, a single
+     * repaint is requested that rebuilds only the invalidated items.
+     */
+    void endUpdate();
+
+    /**
+     * Returns true while a batch update is active
+     */
+    bool isUpdating() const;
+
+    /**
+     * Requests a repaint of the widget. Inside a batch update the request
+     * is deferred until endUpdate().
+     */
+    void scheduleUpdate();
+
+    /**
+     * Enables the quality governor.
+     * The governor measures the frame time and steps through the quality
+     * levels if it exceeds the frame budget. Quality is restored step by
+     * step when there is enough headroom again.
+     * If the gauge is assigned to a QcDashboardScheduler, the scheduler
+     * measures the paint time of all its gauges per frame and the delay of
+     * its frames and degrades the gauges with the lowest priority first.
+     * Otherwise the widget measures the time from a repaint request to the
+     * end of its paint, which includes the paint time of all widgets that
+     * are painted in the same frame. A gauge with a lower priority then
+     * degrades after fewer and restores after more frames.
+     * The governor is disabled by default.
+     */
+    void setQualityGovernorEnabled(bool Enabled);
+    bool qualityGovernorEnabled() const;
+
+    /**
+     * Sets the frame time budget in milliseconds for the quality governor
+     * of a gauge without scheduler. The default is 8 ms.
+     */
+    void setFrameBudget(double Milliseconds);
+    double frameBudget() const;
+
+    /**
+     * Sets the quality level. If the governor is enabled, it will adjust the
+     * level on the next frames.
+     */
+    void setQualityLevel(QualityLevel Level);
+    QualityLevel qualityLevel() const;
+
+    /**
+     * Returns the average paint time of this widget in milliseconds
+     */
+    double averagePaintTime() const;
+
+    /**
+     * Sets the repaint priority used by a QcDashboardScheduler.
+     * Gauges with a higher priority are repainted first. Negative
+     * priorities rank below 0. The default priority is 0.
+     */
+    void setPriority(int Priority);
+    int priority() const;
+
+    /**
+     * Sets the refresh rate range in Hz used by a QcDashboardScheduler.
+     * A changed gauge is repainted at most with MaximumRate and at least
+     * with MinimumRate, even if the frame budget is exhausted.
+     */
+    void setRefreshRateRange(double MinimumRate, double MaximumRate);
+    double minimumRefreshRate() const;
+    double maximumRefreshRate() const;
+
+    /**
+     * Returns the scheduler this gauge is assigned to or 0
+     */
+    QcDashboardScheduler* scheduler() const;
+
+    /**
+     * Returns true if the widget is hidden or minimized.
+     * A dormant widget only stores new values. It does not format labels,
+     * rebuild caches or request repaints until it becomes visible again.
+     */
+    bool isDormant() const;
+
+    /**
+     * Sets the time in milliseconds after which a dormant widget releases
+     * its cached images. A negative value (the default) keeps the caches.
+     */
+    void setDormantCacheTimeout(int Milliseconds);
+    int dormantCacheTimeout() const;
+
+    /**
+     * Releases all cached layer and item images. They are rebuilt on the
+     * next paint.
+     */
+    void releaseCaches();
+
+    /**
+     * Returns the number of bytes held by the cached images of this widget
+     * and its items
+     */
+    qint64 cacheSize() const;
+
+    /**
+     * Enables 16 bit layer images.
+     * If the widget fills its background (see QWidget::autoFillBackground())
+     * the background layer is opaque and is stored as RGB32 image. With
+     * compact layer formats enabled, it is stored as RGB16 image instead,
+     * which halves the memory at the cost of colour depth. Disabled by default.
+     */
+    void setCompactLayerFormats(bool Enabled);
+    bool compactLayerFormats() const;
+
+    /**
+     * Enables the fast needle rendering.
+     * The needle polygon is rasterized with a dedicated exact area coverage
+     * rasterizer into a small image covering only the bounding box of the
+     * needle, which is then blitted over the background layer. Needles with
+     * a solid or linear gradient brush are supported, all other needles are
+     * painted with QPainter. Disabled by default.
+     */
+    void setFastNeedleRendering(bool Enabled);
+    bool fastNeedleRendering() const;
+
+    /**
+     * Sets the diameter from which on the retained item images are rendered
+     * in parallel. Each image is split into horizontal bands that are
+     * painted concurrently by a thread pool private to the gauge library.
+     * Only items that support banded drawing and do not draw text are
+     * rendered this way, and only if the platform supports font rendering
+     * outside the GUI thread. Each band is painted clipped in the
+     * coordinates of the complete image, so the result is identical to a
+     * single threaded paint. The default diameter is 1024 pixels. A value
+     * <= 0 disables the parallel rendering.
+     */
+    void setParallelRenderingThreshold(int Diameter);
+    int parallelRenderingThreshold() const;
+
 protected:
     virtual void paintEvent(QPaintEvent*);
     virtual void resizeEvent(QResizeEvent* event);
+    virtual void timerEvent(QTimerEvent* event);
+    virtual void showEvent(QShowEvent* event);
+    virtual void hideEvent(QHideEvent* event);
+    virtual void changeEvent(QEvent* event);
+
+    /**
+     * Inserts items owned by a subclass, like the inline items of
+     * QcStaticGauge, in front of all added items. The widget does not
+     * delete these items. FirstDynamic and LastDynamic are the indices of
+     * the first and last dynamic item in Items or -1. They are trusted
+     * instead of calling QcItem::isDynamic() for these items.
+     */
+    void insertStaticItems(QcItem* const* Items, int Count, int FirstDynamic,
+    	int LastDynamic);
+
+    /**
+     * Removes the items inserted by insertStaticItems(). A subclass calls
+     * this in its destructor before the items are destroyed.
+     */
+    void removeStaticItems(QcItem* const* Items, int Count);
+
+    /**
+     * Paints the items in the range [First, Last] between the background
+     * and the foreground layer on each paint. A subclass that knows the
+     * item types at compile time may override this to avoid the virtual
+     * dispatch. The default implementation calls drawItem() for each item.
+     */
+    virtual void drawDynamicItems(QPainter* Painter, int First, int Last);
+
+    /**
+     * Paints a dynamic item or blits the retained image of a static item
+     * between dynamic items
+     */
+    void drawItem(QPainter* Painter, int Index);
+
+    /**
+     * Blits the retained image of Item
+     */
+    static void drawCachedItem(QcItem* Item, QPainter* Painter);
+
+private slots:
+    void onModelChanged();
 
 private:
+    friend class QcItem;
+    friend class QcNeedleItem;
+    friend class QcDashboardScheduler;
+    friend class QcCacheManager;
+    friend class QcColorBand;
+    void updateGaugeRect();
+    QcNeedleItem* fastNeedle() const;
+    void drawFastNeedle(QPainter* Painter, QcNeedleItem* Needle);
     void updateBufferImages();
-    QImage createBufferImage() const;
+    void composeLayer(QImage& Layer, int First, int Last);
+    void updateQualityLevel(double PaintTime, double FrameTime);
+    void paintPlaceholder(QPainter& Painter);
+    QImage createBufferImage(QImage::Format Format) const;
+    int renderBandCount() const;
+    void setAlarmFlashing(QcColorBand* Band, bool Flashing);
+    void requestRepaint(int Msecs);
     QImage mBackgroundBuffer; ///<Image buffer for the background
 	QImage mForegeroundBuffer; ///<Image buffer for the foreground
     QList <QcItem*> mItems;
     bool mUpdateBufferImages;
-    int mNeedleItemIndex;
+    bool mBackgroundDirty; ///< background layer needs recompositing
+    bool mForegroundDirty; ///< foreground layer needs recompositing
+    int mFirstDynamicIndex; ///< first item painted on each paint or -1
+    int mLastDynamicIndex; ///< last item painted on each paint or -1
+    QcNeedleItem* mSingleNeedle; ///< the needle, if it is the only dynamic item
+    int mStaticItemCount; ///< number of items inserted by insertStaticItems()
+    int mStaticFirstDynamic; ///< first dynamic static item or -1
+    int mStaticLastDynamic; ///< last dynamic static item or -1
     QPen mBorderPen;
+    int mUpdateLockCount; ///< nesting level of beginUpdate() calls
+    bool mUpdatePending; ///< a repaint was requested during a batch update
+    bool mValuesPending; ///< marked by QcNeedleItem::setValues()
+    bool mQualityGovernorEnabled;
+    QualityLevel mQualityLevel;
+    double mFrameBudget; ///< paint time budget in ms
+    double mAveragePaintTime; ///< moving average of the paint time in ms
+    double mAverageFrameTime; ///< moving average of the frame time in ms
+    int mOverBudgetFrames;
+    int mUnderBudgetFrames;
+    QElapsedTimer mLastPaintTimer; ///< time since the last paint
+    QElapsedTimer mUpdateRequestTimer; ///< time since the pending repaint request
+    QBasicTimer mThrottleTimer; ///< deferred repaint in ReducedUpdateRate
+    QcDashboardScheduler* mScheduler;
+    int mPriority;
+    double mMinimumRefreshRate;
+    double mMaximumRefreshRate;
+    bool mSchedulerDirty; ///< changed since the last paint
+    QElapsedTimer mDirtyTimer; ///< time since the gauge became dirty
+    bool mDormant; ///< hidden or minimized
+    bool mShowsPlaceholder; ///< painted a placeholder instead of the caches
+    bool mSchedulerRender; ///< selected for a repaint by the scheduler
+    bool mLayersRendered; ///< the layers were rendered since the last cache release
+    QcGaugeWidget* mCachePrev; ///< less recently used neighbour in the cache LRU list
+    QcGaugeWidget* mCacheNext; ///< more recently used neighbour in the cache LRU list
+    quint64 mCacheFrame; ///< cache manager frame of the last paint
+    bool mCompactLayerFormats;
+    int mDormantCacheTimeout;
+    QBasicTimer mDormantTimer; ///< releases the caches of a dormant widget
+    QRectF mGaugeRect; ///< square gauge area in the contents rect
+    quint64 mGeometryRevision; ///< incremented if mGaugeRect changes
+    bool mFastNeedleRendering;
+    QImage mNeedleBuffer; ///< rasterized needle for fast needle rendering
+    int mParallelRenderingThreshold;
+    QVector<QcColorBand*> mFlashingBands; ///< bands with a flashing alarm
+    QBasicTimer mFlashTimer; ///< toggles mFlashPhase
+    bool mFlashPhase; ///< alarm overlays are visible
+    QBasicTimer mRepaintTimer; ///< repaint requested by time dependent items
+    QElapsedTimer mRepaintClock; ///< time base of mRepaintDeadline
+    qint64 mRepaintDeadline; ///< time of the pending repaint request
+    QcItemStorage* mItemStorage; ///< pools of the items created by add functions
+};
+
+
+/**
+ * Convenience class for batch updates of a gauge widget.
+ * The constructor calls beginUpdate() and the destructor calls endUpdate().
+ * \code
+ * {
+ *     QcGaugeUpdateLocker Locker(Gauge);
+ *     Values->setRange(0, 200);
+ *     Degrees->setRange(0, 200);
+ *     Needle->setValueRange(0, 200);
+ * } // one repaint here
+ * \endcode
+ */
+class QCGAUGE_DECL QcGaugeUpdateLocker
+{
+public:
+    explicit QcGaugeUpdateLocker(QcGaugeWidget* GaugeWidget)
+        : mGaugeWidget(GaugeWidget)
+    {
+        mGaugeWidget->beginUpdate();
+    }
+
+    ~QcGaugeUpdateLocker()
+    {
+        mGaugeWidget->endUpdate();
+    }
+
+private:
+    Q_DISABLE_COPY(QcGaugeUpdateLocker)
+    QcGaugeWidget* mGaugeWidget;
 };
 
 /**
@@ -123,8 +451,69 @@ public:
     QRectF itemRect() const;
     enum Error{InvalidValueRange,InvalidDegreeRange,InvalidStep};
 
+    /**
+     * Marks the content of this item as changed.
+     * Only the retained image of this item is redrawn on the next paint.
+     */
+    void invalidate();
+
+    /**
+     * Returns true, if the item changes with each frame, like a needle.
+     * The items from the first to the last dynamic item are painted on
+     * each paint. All items before and after them are composed into the
+     * cached background and foreground layers. The default implementation
+     * returns false.
+     */
+    virtual bool isDynamic() const;
+
+    /**
+     * Returns the revision counter of this item. The revision is incremented
+     * each time the item is invalidated.
+     */
+    quint64 revision() const;
+
+    /**
+     * Items are allocated in the item pools of a gauge widget if the widget
+     * is passed as placement argument, like the add functions of
+     * QcGaugeWidget do. Each item type has its own pool, so the items of one
+     * type lie next to each other in a few slabs instead of separate heap
+     * blocks, and the slots of deleted items are reused. Items created with
+     * plain new are allocated on the heap. Both kinds are destroyed with
+     * delete and the pools are released after the widget and the last
+     * pooled item are gone.
+     */
+    static void* operator new(size_t Size);
+    static void* operator new(size_t Size, QcGaugeWidget* GaugeWidget);
+    static void operator delete(void* Ptr);
+    static void operator delete(void* Ptr, QcGaugeWidget* GaugeWidget);
+
 
 protected:
+    /**
+     * Releases the retained image and all other cached images of this item
+     */
+    virtual void releaseCache();
+
+    /**
+     * Returns the number of bytes held by the cached images of this item
+     */
+    virtual qint64 cacheSize() const;
+
+    /**
+     * Updates all lazily computed state that draw() needs for painting on
+     * Device. This is called before the retained image is drawn. The
+     * default implementation computes the item rect.
+     */
+    virtual void prepareDraw(QPaintDevice* Device);
+
+    /**
+     * Returns true, if draw() may be called concurrently from several
+     * threads with painters on different bands of the same image after
+     * prepareDraw(). Such a draw() must not modify the item and must not
+     * draw text. The default implementation returns false.
+     */
+    virtual bool supportsBandedDraw() const;
+
     static double getRadius(const QRectF &);
     static double getAngle(const QPointF&, const QRectF &tmpRect);
     static QPointF getPoint(double deg, const QRectF &tmpRect);
@@ -132,8 +521,24 @@ protected:
     QRectF adjustRect(double percentage) const;
     void update();
 
+    /**
+     * Requests a repaint in Msecs milliseconds for content that changes
+     * with time without new input. Only the earliest request is kept.
+     */
+    void updateAfter(int Msecs);
+
     QcGaugeWidget *mGaugeWidget;
     double mPosition;
+
+private:
+    friend class QcGaugeWidget;
+    void drawCached(QPainter*);
+
+    quint64 mRevision; ///< incremented on each content change
+    quint64 mCacheRevision; ///< revision of mCacheImage
+    mutable QRectF mItemRect; ///< cached result of itemRect()
+    mutable quint64 mItemRectRevision; ///< widget geometry revision of mItemRect
+    QImage mCacheImage; ///< retained image of this item
 };
 
 
@@ -173,9 +578,8 @@ protected:
  * An item for building backgrounds, foregrounds and borders of the
  * gauge widget
  */
-class QCGAUGE_DECL QcBackgroundItem : public QObject, public QcItem
+class QCGAUGE_DECL QcBackgroundItem : public QcItem
 {
-	Q_OBJECT
 public:
     explicit QcBackgroundItem(QcGaugeWidget* ParentWidget);
     virtual ~QcBackgroundItem();
@@ -187,8 +591,11 @@ public:
     void setBrush(const QBrush& Brush);
     const QBrush& brush() const;
 
-private slots:
-	void onWidgetSizeChanged(const QSize& Size);
+protected:
+    void releaseCache();
+    qint64 cacheSize() const;
+    void prepareDraw(QPaintDevice* Device);
+    bool supportsBandedDraw() const;
 
 private:
     void updateDropShadowImage();
@@ -197,6 +604,7 @@ private:
     QList<QPair<double,QColor> > mColors;
     QBrush mBrush;
     QImage mDropShadowImage;
+    int mDropShadowDiameter; ///< widget diameter of mDropShadowImage
     bool mDropShadow;
 };
 
@@ -221,6 +629,9 @@ public:
     void draw(QPainter*);
     void setGlassType(GlassType glassType);
 
+protected:
+    bool supportsBandedDraw() const;
+
 private:
     void createStronglyCurvedGlass(QPainterPath& PainterPath, QBrush& Brush);
     void createCurvedGlass1(QPainterPath& PainterPath, QBrush& Brush);
@@ -247,6 +658,13 @@ public:
     double angle() const;
     void setText(const QString &text, bool repaint = true);
     const QString& text() const;
+
+    /**
+     * Sets the text to Value formatted with the given number of decimals.
+     * The text is formatted into the existing string buffer, so a value
+     * update does not allocate memory.
+     */
+    void setValueText(double Value, int Decimals, bool repaint = true);
     void setColor(const QColor& color);
     const QColor& color() const;
     void setFont(const QFont& font);
@@ -257,12 +675,19 @@ public:
      */
     void setScaleFactor(float Factor);
 
+protected:
+    void prepareDraw(QPaintDevice* Device);
+
 private:
+    void updateFont();
+
     double mAngle;
     QString mText;
     QColor mColor;
+    QPen mPen; ///< pen of mColor
     QFont mFont;
     float mScaleFactor;
+    double mFontRadius; ///< radius mFont is scaled for, negative if invalid
 };
 
 /**
@@ -277,11 +702,27 @@ public:
     void setColor(const QColor& color);
     inline const QColor& color() const {return mColor;}
 
+protected:
+    bool supportsBandedDraw() const;
+
 private:
     QColor mColor;
 };
 
 
+/**
+ * Transition of the alarm zone of a color band
+ */
+struct QcAlarmEvent
+{
+	qint64 Time; ///< milliseconds of the alarm clock of the band
+	double Value; ///< sample that completed the transition
+	qint16 Zone; ///< new zone
+	qint16 PreviousZone; ///< previous zone or -1
+	bool Alarm; ///< the new zone is an alarm zone
+};
+
+
 /**
  * The color band creates an arc of different colors
  */
@@ -289,6 +730,7 @@ class QCGAUGE_DECL QcColorBand : public QcScaleItem
 {
 public:
     explicit QcColorBand(QcGaugeWidget* ParentWidget);
+    virtual ~QcColorBand();
     void draw(QPainter*);
     void setColors(const QList<QPair<QColor,double> >& colors);
 
@@ -298,12 +740,78 @@ public:
      */
     void setPenWidthScaleFactor(float Factor);
 
+    /**
+     * Enables the alarm evaluation of the band. Zone i of the band covers
+     * the values up to the limit of color i, the last zone all values above.
+     * A zone raises an alarm if bit i of AlarmZones is set.
+     * The band evaluates the values of the needles that selected it with
+     * QcNeedleItem::setAlarmBand() or the values passed to
+     * evaluateAlarms(). Use the band alarms for zones with hysteresis, on
+     * delay and flashing. For needles bound to a QcGaugeModel use the alarm
+     * limits of the model instead - they evaluate every sample of the
+     * channel, while the band only sees the values read on each paint.
+     */
+    void setAlarmZones(quint64 AlarmZones);
+
+    /**
+     * Sets how far a value has to pass a zone limit to leave the current
+     * zone. The default is 0.
+     */
+    void setAlarmHysteresis(double Hysteresis);
+
+    /**
+     * Sets how long the values have to stay in a new zone before the
+     * transition is committed. The default is 0.
+     */
+    void setAlarmOnDelay(int Msecs);
+
+    /**
+     * Flashes the current zone while it raises an alarm. The flash is an
+     * overlay painted on top of the cached layers, so the band is not
+     * redrawn.
+     */
+    void setAlarmFlashing(bool Flash);
+
+    /**
+     * Evaluates Count samples. All samples are evaluated with the time Msecs
+     * of the alarm clock. The evaluation does not allocate memory. Returns
+     * the number of transitions.
+     */
+    int evaluateAlarms(const double* Values, int Count, qint64 Msecs);
+
+    /**
+     * Evaluates Count samples with the current time of the alarm clock
+     */
+    int evaluateAlarms(const double* Values, int Count);
+
+    /**
+     * Returns the current zone or -1 if no zone has been committed yet
+     */
+    int alarmZone() const;
+    bool alarmActive() const;
+
+    /**
+     * Moves up to MaxCount of the oldest transitions into Events and
+     * returns their number. The band keeps the last 64 transitions.
+     */
+    int takeAlarmEvents(QcAlarmEvent* Events, int MaxCount);
+
+protected:
+    bool supportsBandedDraw() const;
+
 private:
+   friend class QcGaugeWidget;
+   friend class QcNeedleItem;
    QPainterPath createSubBand(double from,double sweep);
+   QcAlarmState* alarm();
+   void updateZoneLimits();
+   void commitZone(int Zone, double Value, qint64 Msecs);
+   void drawAlarmOverlay(QPainter* painter);
 
    QList<QPair<QColor,double> > mBandColors;
    double mBandStartValue;
    float mPenWidthScaleFactor;
+   QcAlarmState* mAlarm; ///< alarm evaluation state, created on first use
 };
 
 /**
@@ -317,6 +825,10 @@ public:
     void setStep(double step);
     void setColor(const QColor& color);
     void setSubDegree(bool );
+
+protected:
+    bool supportsBandedDraw() const;
+
 private:
     double mStep;
     QColor mColor;
@@ -324,16 +836,72 @@ private:
 };
 
 
+/**
+ * Input filter for the values of a needle.
+ * The filter processes batches of samples in contiguous arrays. The
+ * meaning of the parameter depends on the filter type:
+ * - ExponentialMovingAverage: smoothing factor in the range (0, 1]
+ * - MovingAverage, Median: number of samples in the window
+ * - RateLimit: maximum change of the output per sample
+ * - Deadband: minimum change of the input that changes the output
+ */
+class QCGAUGE_DECL QcSampleFilter
+{
+public:
+	enum FilterType
+	{
+		NoFilter,
+		ExponentialMovingAverage,
+		MovingAverage,
+		Median,
+		RateLimit,
+		Deadband
+	};
+
+	explicit QcSampleFilter(FilterType Type = NoFilter, double Parameter = 0);
+	FilterType type() const;
+	double parameter() const;
+
+	/**
+	 * Filters Count samples from Input into Output. Input and Output may
+	 * be the same array. The filter state carries over to the next call.
+	 */
+	void process(const double* Input, double* Output, int Count);
+
+	/**
+	 * Clears the filter state. The next sample passes unchanged.
+	 */
+	void reset();
+
+private:
+	void processWindow(const double* Input, double* Output, int Count);
+	void averageBlock(const double* Input, double* Output, int Count);
+
+	FilterType mType;
+	double mParameter;
+	int mWindow; ///< window size of MovingAverage and Median
+	bool mPrimed; ///< mLast holds the previous output
+	double mLast;
+	QVector<double> mRing; ///< last mWindow samples of MovingAverage and Median
+	QVector<double> mScratch; ///< sorted window of Median, next ring of MovingAverage
+	double mSum; ///< sum of the samples in mRing
+	int mHead; ///< next write position in mRing
+	int mCount; ///< number of valid samples in mRing
+};
+
+
 /**
  * The needle item shows the value by pointing on a certain value on the
- * scale of the gauge widget
+ * scale of the gauge widget.
+ * The needle is no QObject. Connect signals to the slots of proxy().
  */
-class QCGAUGE_DECL QcNeedleItem : public QObject, public QcScaleItem
+class QCGAUGE_DECL QcNeedleItem : public QcScaleItem
 {
-	Q_OBJECT
 public:
     explicit QcNeedleItem(QcGaugeWidget* ParentWidget);
+    virtual ~QcNeedleItem();
     void draw(QPainter*);
+    bool isDynamic() const;
     double value() const;
     void setColor(const QColor & color);
     const QColor& color() const;
@@ -375,16 +943,140 @@ public:
      */
     int decimals() const;
 
-public slots:
+    /**
+     * Sets the values of many needles in one call.
+     * Needles and Values are two arrays of Count elements. All values are
+     * clamped and mapped to needle angles in a single pass and each affected
+     * gauge widget is repainted only once. The needles may belong to
+     * different gauge widgets. Linked labels are formatted on the next paint.
+     * The value of a needle bound to a model is written into the model.
+     */
+    static void setValues(QcNeedleItem* const* Needles, const double* Values,
+        int Count);
+
+    /**
+     * Binds the needle to a channel of a value model.
+     * A bound needle reads its value from the model when the gauge is
+     * painted, so one model can drive any number of gauge widgets.
+     * setValue() and addSamples() on a bound needle write the values into
+     * the model. A bound needle does not run its filter and the peak hold,
+     * the envelope and the band alarms only see the model value read on
+     * each paint, so samples between two paints are missed. Use the peaks
+     * and alarm limits of QcGaugeModel to track every sample of a channel.
+     * Pass 0 to unbind the needle.
+     */
+    void setModel(QcGaugeModel* Model, int Channel);
+    QcGaugeModel* model() const;
+    int modelChannel() const;
+
+    /**
+     * Returns the number of value updates that did not request a repaint
+     * because the needle tip moved less than half a device pixel and the
+     * label text did not change.
+     */
+    quint64 suppressedUpdates() const;
+
+    /**
+     * Returns the QObject facade of this needle for signal and slot
+     * connections. The facade is created on the first call and is owned
+     * by the needle.
+     */
+    QcNeedleProxy* proxy();
+
+    /**
+     * Enables a marker at the highest value within the hold window.
+     * All values passed to setValue() and setValues() are tracked, not only
+     * the painted ones. A needle bound to a model tracks the values it
+     * reads on each paint.
+     */
+    void setPeakHold(bool Enable);
+    bool peakHold() const;
+
+    /**
+     * Enables a marker at the lowest value within the hold window
+     */
+    void setMinimumHold(bool Enable);
+    bool minimumHold() const;
+
+    /**
+     * Sets the sliding window of the peak and minimum hold. Msecs limits
+     * the age and Samples the number of the tracked values. A limit of 0
+     * is disabled - if both limits are 0, the markers hold until
+     * resetHold() is called. The default is a window of 10 seconds. The
+     * age limit is applied when a value is set and when the needle is
+     * painted - the gauge repaints when the oldest marker expires, also
+     * if no new values arrive.
+     */
+    void setHoldWindow(int Msecs, int Samples = 0);
+
+    /**
+     * Restarts the peak and minimum hold at the current value
+     */
+    void resetHold();
+
+    /**
+     * Returns the highest value within the hold window or the current
+     * value if the peak hold is disabled
+     */
+    double heldPeak() const;
+
+    /**
+     * Returns the lowest value within the hold window or the current
+     * value if the minimum hold is disabled
+     */
+    double heldMinimum() const;
+    void setHoldMarkerColor(const QColor& color);
+
+    /**
+     * Enables the envelope mode. The needle shows the latest value and a
+     * translucent sector below the needle spans the minimum and maximum of
+     * all values set since the previous paint, so fast excursions between
+     * two frames stay visible. After a frame with an envelope the gauge
+     * repaints once more, so the sector disappears when the values stop.
+     * A needle bound to a model only sees the values it reads on each
+     * paint.
+     */
+    void setEnvelope(bool Enable);
+    bool envelope() const;
+    void setEnvelopeColor(const QColor& color);
+
+    /**
+     * Sets the input filter of the needle. All values passed to setValue(),
+     * setValues() and addSamples() are filtered before they are shown and
+     * tracked by the label, the peak hold and the envelope. The values of a
+     * bound model are not filtered.
+     */
+    void setFilter(const QcSampleFilter& Filter);
+    const QcSampleFilter* filter() const;
+
+    /**
+     * Adds a batch of samples in one call. The samples are filtered as one
+     * contiguous array, all filtered samples feed the peak hold and the
+     * envelope and the needle shows the last one. A repaint is requested
+     * at most once.
+     */
+    void addSamples(const double* Values, int Count);
+
+    /**
+     * Evaluates all filtered values of the needle against the alarm zones
+     * of Band. A needle bound to a model evaluates only the values it reads
+     * on each paint. Pass 0 to stop the evaluation.
+     */
+    void setAlarmBand(QcColorBand* Band);
+    QcColorBand* alarmBand() const;
+
     void setValue(double value);
     void setValueRange(double minValue,double maxValue);
     void setMinimumValue(double minValue);
     void setMaximumValue(double maxValue);
 
-private slots:
-	void onWidgetSizeChanged(const QSize& Size);
+protected:
+    void releaseCache();
+    qint64 cacheSize() const;
 
 private:
+    friend class QcGaugeWidget;
+    friend class QcColorBand;
     QPolygonF createDiamonNeedle(double r) const;
     QPolygonF createTriangleNeedle(double r) const;
     QPolygonF createFeatherNeedle(double r) const;
@@ -393,20 +1085,93 @@ private:
     QPolygonF createCustomNeedle(double r) const;
 
     QPolygonF createNeedlePoly(double r) const;
+    const QPolygonF& needlePoly(double Radius);
     void updateDropShadowImage();
 
+    double prepareFrame();
+    void drawDecorations(QPainter* painter, double Degree);
+    bool canRasterize() const;
+    QRect rasterize(QImage& Buffer, double Degree, bool Antialiased);
+
+    double currentDegree();
+    void syncModelValue();
+    QcHoldTracker* hold();
+    bool extendEnvelope(double Value);
+    void drawEnvelope(QPainter* painter);
+    void drawHoldMarker(QPainter* painter, double Value, double Radius);
+    bool changesVisibly(double Value, double Degree) const;
+
     QPolygonF mCustomNeedlePoly;
+    QPolygonF mNeedlePoly; ///< needle polygon cached for mNeedlePolyRadius
+    QRectF mNeedlePolyRect; ///< bounding rect of mNeedlePoly
+    double mNeedlePolyRadius; ///< radius of mNeedlePoly, negative if invalid
     double mCurrentValue;
+    double mCurrentDegree; ///< needle angle of mCurrentValue
+    quint64 mDegreeRevision; ///< item revision mCurrentDegree was computed for
+    bool mLabelDirty; ///< linked label text needs to be formatted
+    double mLabelScale; ///< 10^mDecimals
+    bool mPainted; ///< the following painted state is valid
+    double mPaintedDegree; ///< needle angle of the last paint
+    double mPaintedTipRadius; ///< needle tip distance of the last paint
+    double mPaintedLabelKey; ///< quantized label value of the last paint
+    quint64 mSuppressedUpdates;
+    QcNeedleProxy* mProxy;
+    QcHoldTracker* mHold; ///< peak and minimum hold, created on first use
+    QcSampleFilter* mFilter; ///< input filter or 0
+    QcColorBand* mAlarmBand; ///< band that evaluates the values or 0
+    bool mEnvelope;
+    double mEnvelopeMin; ///< minimum value since the last paint
+    double mEnvelopeMax; ///< maximum value since the last paint
+    double mFrameMin; ///< envelope minimum of the current paint
+    double mFrameMax; ///< envelope maximum of the current paint
+    QBrush mEnvelopeBrush;
+    QVector<QPointF> mEnvelopePolygon; ///< cached envelope sector
+    QRectF mEnvelopePolygonRect; ///< item rect of mEnvelopePolygon
+    double mEnvelopePolygonMin; ///< minimum angle of mEnvelopePolygon
+    double mEnvelopePolygonMax; ///< maximum angle of mEnvelopePolygon
+    QPointer<QcGaugeModel> mModel;
+    int mModelChannel;
     NeedleType mNeedleType;
     QcLabelItem *mLabel;
     QBrush mBrush;
+    QVector<uint> mGradientTable; ///< colours of a gradient brush for rasterize()
+    QVector<float> mCoverage; ///< area accumulation buffer of rasterize()
     QImage mDropShadowImage;
+    int mDropShadowDiameter; ///< widget diameter of mDropShadowImage
     bool mDropShadow;
     float mThicknessFactor;
     int mDecimals;
 };
 
 
+/**
+ * QObject facade of a needle item.
+ * Needle items are no QObjects to keep large numbers of gauges lean. If a
+ * needle should be driven by signals, connect them to the slots of the
+ * facade returned by QcNeedleItem::proxy().
+ * \code
+ * connect(SpinBox, SIGNAL(valueChanged(double)),
+ *     Needle->proxy(), SLOT(setValue(double)));
+ * \endcode
+ */
+class QCGAUGE_DECL QcNeedleProxy : public QObject
+{
+	Q_OBJECT
+public:
+	explicit QcNeedleProxy(QcNeedleItem* Needle);
+	QcNeedleItem* needle() const;
+
+public slots:
+	void setValue(double value);
+	void setValueRange(double minValue,double maxValue);
+	void setMinimumValue(double minValue);
+	void setMaximumValue(double maxValue);
+
+private:
+	QcNeedleItem* mNeedle;
+};
+
+
 /**
  * A value item paints the values of a scale.
  */
@@ -427,6 +1192,9 @@ public:
      */
     void setScaleFactor(float ScaleFactor);
 
+protected:
+    void prepareDraw(QPaintDevice* Device);
+
 private:
     double mStep;
     QColor mColor;
@@ -436,6 +1204,262 @@ private:
 };
 
 
+/**
+ * A dial that rotates a group of scale items, like the card of a heading
+ * indicator that turns below a fixed lubber line.
+ * The scale items of the dial are rendered once into a cached dial image,
+ * which is rotated on each paint. Static items added to the gauge after the
+ * dial, like a glass or a fixed pointer, stay on top of the dial in the
+ * cached foreground layer.
+ */
+class QCGAUGE_DECL QcRotatingDialItem : public QcItem
+{
+public:
+    explicit QcRotatingDialItem(QcGaugeWidget* ParentWidget);
+    virtual ~QcRotatingDialItem();
+    void draw(QPainter*);
+    bool isDynamic() const;
+
+    QcDegreesItem* addDegrees(double position);
+    QcValuesItem* addValues(double position);
+    QcArcItem* addArc(double position);
+    QcColorBand* addColorBand(double position);
+    QcLabelItem* addLabel(double position);
+
+    /**
+     * Adds an item to the dial. The dial takes ownership of the item.
+     */
+    void addItem(QcItem* item, double position);
+    QList<QcItem*> items() const;
+
+    /**
+     * Sets the rotation of the dial in degree. The dial is rotated
+     * counterclockwise by Value, so the scale value Value of a heading
+     * scale moves to the position of scale value 0.
+     */
+    void setValue(double Value);
+    double value() const;
+
+    /**
+     * Quantizes the rotation to multiples of Step degree.
+     * One pre-rotated sprite of the dial is cached per distinct rotation
+     * angle, so a paint only blits a sprite instead of rotating the dial
+     * image. Each sprite has the size of the dial image. The sprites of a
+     * dial are limited to 32 MB - if a new angle exceeds the limit, the
+     * least recently painted sprite is dropped. The sprites are counted in
+     * the cache budget of the widget and released with its caches. Steps
+     * that do not divide 360 are applied to the unwrapped value. A step of
+     * 0 disables the quantization. The default is 0.
+     */
+    void setRotationStep(double Step);
+    double rotationStep() const;
+
+protected:
+    void releaseCache();
+    qint64 cacheSize() const;
+
+private:
+    /**
+     * Pre-rotated dial image
+     */
+    struct Sprite
+    {
+    	QImage Image;
+    	quint64 LastUse; ///< mSpriteClock of the last paint of the sprite
+    };
+
+    quint64 contentKey() const;
+    QImage renderDial(double Angle);
+    void evictSprite();
+
+    QList<QcItem*> mDialItems;
+    double mValue;
+    double mRotationStep;
+    QImage mDialImage; ///< the unrotated dial
+    quint64 mDialKey; ///< content key of mDialImage and mSprites
+    QHash<qint64, Sprite> mSprites; ///< pre-rotated dials per millidegree angle
+    quint64 mSpriteClock; ///< incremented for each painted sprite
+};
+
+
+/**
+ * A vertical scrolling tape scale, like the altitude or airspeed tape of a
+ * primary flight display. The value increases upwards and the current value
+ * is shown at the index line in the middle of the tape.
+ * The ticks and labels are rendered into strip chunks that cover one
+ * visible span of the tape each. A paint only blits the window of the one
+ * or two chunks that intersect the tape. Chunks are rendered on demand when
+ * the value moves into a range that has not been rendered yet.
+ */
+class QCGAUGE_DECL QcTapeItem : public QcItem
+{
+public:
+    explicit QcTapeItem(QcGaugeWidget* ParentWidget);
+    void draw(QPainter*);
+    bool isDynamic() const;
+
+    void setValue(double Value);
+    double value() const;
+
+    /**
+     * Sets the value range that is visible in the tape at once.
+     * The default is 100.
+     */
+    void setVisibleSpan(double Span);
+    double visibleSpan() const;
+
+    /**
+     * Limits the ticks and labels to the range from minValue to maxValue.
+     * The tape is unlimited by default.
+     */
+    void setRange(double minValue, double maxValue);
+    double minimumValue() const;
+    double maximumValue() const;
+
+    /**
+     * Sets the value distance of the ticks. The default is 10.
+     */
+    void setStep(double step);
+
+    /**
+     * Sets the value distance of the labelled major ticks. The default is 50.
+     * A step of 0 disables the labels.
+     */
+    void setLabelStep(double step);
+    void setDecimals(int Value);
+    void setColor(const QColor& color);
+    void setBackgroundColor(const QColor& color);
+
+    /**
+     * Sets the font of the labels. If the font has no explicit size, it
+     * is scaled with the tape height.
+     */
+    void setFont(const QFont& font);
+    const QFont& font() const;
+
+    /**
+     * Sets the width of the tape in percent of the item rect width.
+     * The default is 40.
+     */
+    void setTapeWidth(double percentage);
+
+protected:
+    void releaseCache();
+    qint64 cacheSize() const;
+
+private:
+    QRectF tapeRect() const;
+    QImage renderChunk(int Chunk, int Width, int Height);
+
+    double mValue;
+    double mVisibleSpan;
+    double mMinValue;
+    double mMaxValue;
+    double mStep;
+    double mLabelStep;
+    double mTapeWidth;
+    int mDecimals;
+    QColor mColor;
+    QColor mBackgroundColor;
+    QFont mFont;
+    QFont mStripFont; ///< mFont scaled to the chunk height
+    bool mExplicitFontSize; ///< mFont has a size set by the user
+    QPen mIndexPen; ///< pen of the index line
+    QHash<int, QImage> mChunks; ///< rendered strip chunks by chunk index
+    QSize mChunkSize; ///< size of the chunks in mChunks
+    quint64 mChunkRevision; ///< item revision of the chunks in mChunks
+};
+
+
+/**
+ * A trend trace of the recent values inside the dial face.
+ * The samples are kept in a ring buffer of fixed capacity. The trace is
+ * drawn into a layer image with one pixel column per time slice. Each
+ * column shows the minimum and maximum of its samples, so peaks stay
+ * visible at any sample rate. When time advances, the layer is scrolled
+ * left in place and only the new columns are drawn.
+ * Add the history item right before the needle to paint it below the
+ * needle.
+ */
+class QCGAUGE_DECL QcHistoryItem : public QcItem
+{
+public:
+    explicit QcHistoryItem(QcGaugeWidget* ParentWidget);
+    void draw(QPainter*);
+    bool isDynamic() const;
+
+    /**
+     * Appends a sample with the current time. If the ring buffer is full,
+     * the oldest sample is dropped.
+     */
+    void addSample(double Value);
+    void clear();
+
+    /**
+     * Sets the number of samples the ring buffer holds and clears it.
+     * The default is 2048.
+     */
+    void setCapacity(int Capacity);
+    int capacity() const;
+
+    /**
+     * Sets the time span shown by the trace in seconds. The default is 10.
+     */
+    void setTimeSpan(double Seconds);
+    double timeSpan() const;
+
+    void setRange(double minValue, double maxValue);
+    void setColor(const QColor& color);
+
+    /**
+     * Sets the rect of the trace relative to the item rect. A rect of
+     * (0, 0, 1, 1) fills the item rect. The default is (0.25, 0.6, 0.5, 0.2),
+     * a strip below the centre of the dial.
+     */
+    void setTraceRect(const QRectF& Rect);
+
+protected:
+    void releaseCache();
+    qint64 cacheSize() const;
+
+    /**
+     * Returns the time of the trace in milliseconds. The samples are
+     * stamped with it and the trace scrolls with it. The default
+     * implementation returns the time since the item was created.
+     */
+    virtual qint64 currentTime() const;
+
+private:
+    struct Sample
+    {
+        qint64 Time; ///< currentTime() of the sample
+        double Value;
+    };
+
+    const Sample& sample(int Index) const;
+    qint64 column(qint64 Time) const;
+    QRect traceRect() const;
+    void scrollTrace(int Columns);
+    void drawColumns(qint64 FirstColumn, qint64 LastColumn);
+    void plotColumn(qint64 Column, double Min, double Max);
+
+    QVector<Sample> mSamples; ///< ring buffer
+    int mHead; ///< index of the oldest sample
+    int mCount; ///< number of samples in the ring buffer
+    QElapsedTimer mClock;
+    double mTimeSpan;
+    double mMinValue;
+    double mMaxValue;
+    QColor mColor;
+    QRectF mTraceRect;
+    QImage mTraceImage; ///< scrolling trace layer
+    double mColumnTime; ///< milliseconds per pixel column of mTraceImage
+    qint64 mLastColumn; ///< column shown at the right edge of mTraceImage
+    quint64 mTraceRevision; ///< item revision of mTraceImage
+    bool mNewSamples; ///< samples were added since the last paint
+};
+
+
 /**
  * This is a special item for painting an altitude meter
  */
@@ -469,4 +1493,461 @@ private:
 
 };
 
+
+/**
+ * A value model that holds the channel values, ranges and derived state
+ * like peaks and alarms of one or more gauges.
+ * The model is independent from any view. Needles of several gauge widgets
+ * can be bound to the same channel via QcNeedleItem::setModel(). Each
+ * sample is stored once and every view reads the model when it paints.
+ */
+class QCGAUGE_DECL QcGaugeModel : public QObject
+{
+	Q_OBJECT
+signals:
+	/**
+	 * Emitted once per setValue() or setValues() call
+	 */
+	void changed();
+
+	/**
+	 * Emitted if the alarm state of a channel changed
+	 */
+	void alarmChanged(int Channel, int State);
+
+public:
+	enum AlarmState
+	{
+		NoAlarm,
+		LowAlarm,
+		HighAlarm
+	};
+
+	explicit QcGaugeModel(QObject* parent = 0);
+	virtual ~QcGaugeModel();
+
+	/**
+	 * Adds a new channel and returns its index
+	 */
+	int addChannel(double minValue = 0, double maxValue = 100);
+	int channelCount() const;
+
+	void setRange(int Channel, double minValue, double maxValue);
+	double minimumValue(int Channel) const;
+	double maximumValue(int Channel) const;
+
+	void setValue(int Channel, double Value);
+
+	/**
+	 * Stores Count samples given as two arrays of channel indexes and values
+	 * and emits changed() once.
+	 */
+	void setValues(const int* Channels, const double* Values, int Count);
+	double value(int Channel) const;
+
+	/**
+	 * Returns the highest value since the last resetPeaks() call
+	 */
+	double peak(int Channel) const;
+
+	/**
+	 * Returns the lowest value since the last resetPeaks() call
+	 */
+	double trough(int Channel) const;
+	void resetPeaks(int Channel);
+
+	/**
+	 * Sets the limits for the alarm state of a channel. A value below Low
+	 * raises a LowAlarm, a value above High raises a HighAlarm. Every
+	 * sample written into the channel is evaluated. The zone alarms of
+	 * QcColorBand do not apply to the channel values.
+	 */
+	void setAlarmLimits(int Channel, double Low, double High);
+	AlarmState alarmState(int Channel) const;
+
+	/**
+	 * Returns a counter that is incremented with each change of the model
+	 */
+	quint64 revision() const;
+
+private:
+	void ingest(int Channel, double Value);
+
+	QVector<double> mValues;
+	QVector<double> mMinValues;
+	QVector<double> mMaxValues;
+	QVector<double> mPeaks;
+	QVector<double> mTroughs;
+	QVector<double> mLowLimits;
+	QVector<double> mHighLimits;
+	QVector<int> mAlarmStates;
+	quint64 mRevision;
+};
+
+
+/**
+ * Repaint scheduler for dashboards with many gauges.
+ * Gauges added to the scheduler no longer repaint themselves when they
+ * change. Instead, the scheduler repaints the changed gauges once per frame
+ * ordered by priority and staleness until the CPU time budget of the frame
+ * is used up. Gauges that are about to exceed the staleness allowed by
+ * their minimum refresh rate are always repainted.
+ */
+class QCGAUGE_DECL QcDashboardScheduler : public QObject
+{
+	Q_OBJECT
+signals:
+	/**
+	 * Emitted after each frame with the number of gauges scheduled for a
+	 * repaint and the number of changed gauges that were deferred to a later
+	 * frame by the frame budget or by their maximum refresh rate
+	 */
+	void frameFinished(int Painted, int Deferred);
+
+public:
+	explicit QcDashboardScheduler(QObject* parent = 0);
+	virtual ~QcDashboardScheduler();
+
+	void addGauge(QcGaugeWidget* Gauge);
+	void removeGauge(QcGaugeWidget* Gauge);
+	QList<QcGaugeWidget*> gauges() const;
+
+	/**
+	 * Sets the frame rate of the scheduler in Hz. The default is 60 Hz.
+	 */
+	void setFrameRate(double Rate);
+	double frameRate() const;
+
+	/**
+	 * Sets the CPU time budget in milliseconds for repainting gauges in one
+	 * frame. The cost of a gauge is estimated from its measured average
+	 * paint time. The default is 8 ms.
+	 */
+	void setFrameBudget(double Milliseconds);
+	double frameBudget() const;
+
+	/**
+	 * Returns the gauges that were changed but not repainted in the last
+	 * frame
+	 */
+	QList<QcGaugeWidget*> deferredGauges() const;
+
+	/**
+	 * Enables progressive rendering.
+	 * While the scheduler is active, gauges that are exposed for the first
+	 * time or after releasing their caches show a placeholder until the
+	 * scheduler builds their caches in priority order within the frame
+	 * budget. This spreads the startup cost of large dashboards over several
+	 * frames. Disabled by default.
+	 */
+	void setProgressiveRendering(bool Enabled);
+	bool progressiveRendering() const;
+
+	/**
+	 * Returns the time in milliseconds from start() until the first frame
+	 * that painted a gauge, or -1 if no frame was painted yet
+	 */
+	qint64 timeToFirstFrame() const;
+
+	/**
+	 * Returns the time in milliseconds from start() until the first frame
+	 * in which no visible gauge showed a placeholder, or -1
+	 */
+	qint64 timeToAllGaugesRendered() const;
+
+	void start();
+	void stop();
+	bool isActive() const;
+
+public slots:
+	/**
+	 * Repaints the changed gauges of one frame. This is called by the frame
+	 * timer, but may also be called directly to drive the scheduler from an
+	 * external frame clock.
+	 */
+	void processFrame();
+
+protected:
+	virtual void timerEvent(QTimerEvent* event);
+
+private:
+	friend class QcGaugeWidget;
+	void gaugePainted(QcGaugeWidget* Gauge, double PaintTime, bool Regenerated);
+	void updateQualityLevels(double FrameDelay);
+
+	QList<QcGaugeWidget*> mGauges;
+	QList<QcGaugeWidget*> mDeferredGauges;
+	QBasicTimer mFrameTimer;
+	double mFrameRate;
+	double mFrameBudget;
+	bool mProgressiveRendering;
+	double mAverageRegenTime; ///< average paint time with cache regeneration in ms
+	QElapsedTimer mStartupTimer;
+	qint64 mTimeToFirstFrame;
+	qint64 mTimeToAllGaugesRendered;
+	QElapsedTimer mFrameClock; ///< time since the last processFrame() call
+	double mFramePaintTime; ///< paint time of all gauges since the last frame
+	int mOverBudgetFrames;
+	int mUnderBudgetFrames;
+};
+
+
+/**
+ * Process wide manager for the memory used by cached gauge images.
+ * Every gauge widget reports the bytes held by its caches after painting.
+ * If the total exceeds the budget, the caches of the least recently used
+ * gauges are released, dormant gauges first. The caches of gauges painted
+ * in the current event loop iteration are never released. Released caches
+ * are rebuilt when the gauge is painted again.
+ */
+class QCGAUGE_DECL QcCacheManager
+{
+public:
+	static QcCacheManager* instance();
+
+	/**
+	 * Sets the cache memory budget in bytes. A value <= 0 (the default)
+	 * disables the budget.
+	 */
+	void setBudget(qint64 Bytes);
+	qint64 budget() const;
+
+	/**
+	 * Returns the bytes held by the caches of all gauge widgets
+	 */
+	qint64 totalUsage() const;
+
+	/**
+	 * Returns the bytes held by the caches of the given gauge widget
+	 */
+	qint64 usage(const QcGaugeWidget* Widget) const;
+
+private:
+	friend class QcGaugeWidget;
+	QcCacheManager();
+	Q_DISABLE_COPY(QcCacheManager)
+
+	void updateUsage(QcGaugeWidget* Widget, qint64 Bytes);
+	void removeWidget(QcGaugeWidget* Widget);
+	void widgetHidden(QcGaugeWidget* Widget);
+	void enforceBudget(QcGaugeWidget* CurrentWidget);
+	void link(QcGaugeWidget* Widget, bool MostRecent);
+	void unlink(QcGaugeWidget* Widget);
+	bool paintedInCurrentFrame(const QcGaugeWidget* Widget) const;
+	static void endFrame();
+
+	QHash<QcGaugeWidget*, qint64> mUsage; ///< widgets with caches
+	qint64 mTotalUsage;
+	qint64 mBudget;
+	QcGaugeWidget* mLeastRecent; ///< head of the LRU list, evicted first
+	QcGaugeWidget* mMostRecent; ///< tail of the LRU list
+	quint64 mFrame; ///< counts the event loop iterations with paints
+	bool mFrameOpen; ///< a widget was painted in the current iteration
+};
+
+
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#include <tuple>
+#include <type_traits>
+
+namespace QcStaticGaugeDetail
+{
+/**
+ * An item type is dynamic if it derives from one of the item classes that
+ * are painted on each paint
+ */
+template <class T>
+struct IsDynamicItem
+{
+	static const bool value = std::is_base_of<QcNeedleItem, T>::value
+		|| std::is_base_of<QcRotatingDialItem, T>::value
+		|| std::is_base_of<QcTapeItem, T>::value
+		|| std::is_base_of<QcHistoryItem, T>::value;
+};
+
+/**
+ * Index of the first dynamic item in Items or -1
+ */
+template <int I, class... Items>
+struct FirstDynamicIndex
+{
+	static const int value = -1;
+};
+
+template <int I, class First, class... Rest>
+struct FirstDynamicIndex<I, First, Rest...>
+{
+	static const int value = IsDynamicItem<First>::value
+		? I : FirstDynamicIndex<I + 1, Rest...>::value;
+};
+
+/**
+ * Index of the last dynamic item in Items or -1
+ */
+template <int I, class... Items>
+struct LastDynamicIndex
+{
+	static const int value = -1;
+};
+
+template <int I, class First, class... Rest>
+struct LastDynamicIndex<I, First, Rest...>
+{
+	static const int value = (LastDynamicIndex<I + 1, Rest...>::value >= 0)
+		? LastDynamicIndex<I + 1, Rest...>::value
+		: (IsDynamicItem<First>::value ? I : -1);
+};
+
+/**
+ * Index of the first needle item in Items or -1
+ */
+template <int I, class... Items>
+struct NeedleIndex
+{
+	static const int value = -1;
+};
+
+template <int I, class First, class... Rest>
+struct NeedleIndex<I, First, Rest...>
+{
+	static const int value = std::is_base_of<QcNeedleItem, First>::value
+		? I : NeedleIndex<I + 1, Rest...>::value;
+};
+
+template <int... I>
+struct IndexList {};
+
+template <int N, int... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+
+template <int... I>
+struct MakeIndexList<0, I...>
+{
+	typedef IndexList<I...> type;
+};
+} // namespace QcStaticGaugeDetail
+
+
+/**
+ * Gauge widget with a fixed list of items known at compile time.
+ * The items are stored inline in the widget in the given paint order. The
+ * items are painted by the same code as the items of QcGaugeWidget and all
+ * features of QcGaugeWidget are available. Further items may still be added
+ * with the add functions - they are painted after the inline items.
+ * The dynamic items are determined from the item types at compile time -
+ * types derived from QcNeedleItem, QcRotatingDialItem, QcTapeItem and
+ * QcHistoryItem are dynamic. The inline items are painted with non virtual
+ * calls.
+ * \code
+ * QcStaticGauge<QcBackgroundItem, QcDegreesItem, QcValuesItem,
+ *     QcNeedleItem, QcGlassItem> Gauge;
+ * Gauge.item<0>().setPosition(88);
+ * Gauge.item<3>().setValueRange(0, 80);
+ * \endcode
+ */
+template <class... Items>
+class QcStaticGauge : public QcGaugeWidget
+{
+public:
+	/**
+	 * Index of the first needle in Items or -1 if there is no needle
+	 */
+	static const int NeedleIndex = QcStaticGaugeDetail::NeedleIndex<0, Items...>::value;
+
+	/**
+	 * Indices of the first and last dynamic item in Items or -1
+	 */
+	static const int FirstDynamicIndex = QcStaticGaugeDetail::FirstDynamicIndex<0, Items...>::value;
+	static const int LastDynamicIndex = QcStaticGaugeDetail::LastDynamicIndex<0, Items...>::value;
+
+	explicit QcStaticGauge(QWidget* parent = 0)
+		: QcGaugeWidget(parent),
+		  mStaticItems(itemParent<Items>(this)...)
+	{
+		attachItems(Indices(), true);
+	}
+
+	virtual ~QcStaticGauge()
+	{
+		attachItems(Indices(), false);
+	}
+
+	/**
+	 * Returns the item with the given index
+	 */
+	template <int I>
+	typename std::tuple_element<I, std::tuple<Items...> >::type& item()
+	{
+		return std::get<I>(mStaticItems);
+	}
+
+protected:
+	virtual void drawDynamicItems(QPainter* Painter, int First, int Last)
+	{
+		drawStaticItems(Painter, First, Last, Indices());
+		for (int i = qMax(First, int(sizeof...(Items))); i <= Last; ++i)
+		{
+			drawItem(Painter, i);
+		}
+	}
+
+private:
+	static_assert(sizeof...(Items) > 0, "QcStaticGauge requires at least one item");
+	typedef typename QcStaticGaugeDetail::MakeIndexList<sizeof...(Items)>::type Indices;
+
+	template <class T>
+	static QcGaugeWidget* itemParent(QcGaugeWidget* Widget)
+	{
+		return Widget;
+	}
+
+	template <int... I>
+	void attachItems(QcStaticGaugeDetail::IndexList<I...>, bool Attach)
+	{
+		QcItem* ItemList[] = {&std::get<I>(mStaticItems)...};
+		if (Attach)
+		{
+			insertStaticItems(ItemList, sizeof...(I), FirstDynamicIndex,
+				LastDynamicIndex);
+		}
+		else
+		{
+			removeStaticItems(ItemList, sizeof...(I));
+		}
+	}
+
+	template <int... I>
+	void drawStaticItems(QPainter* Painter, int First, int Last,
+		QcStaticGaugeDetail::IndexList<I...>)
+	{
+		int Expand[] = {0, (drawStaticItem<I>(Painter, First, Last), 0)...};
+		(void)Expand;
+	}
+
+	/**
+	 * Paints the inline item I with a qualified, non virtual call
+	 */
+	template <int I>
+	void drawStaticItem(QPainter* Painter, int First, int Last)
+	{
+		typedef typename std::tuple_element<I, std::tuple<Items...> >::type ItemType;
+		if (I < First || I > Last)
+		{
+			return;
+		}
+		ItemType& Item = std::get<I>(mStaticItems);
+		if (QcStaticGaugeDetail::IsDynamicItem<ItemType>::value)
+		{
+			Item.ItemType::draw(Painter);
+		}
+		else
+		{
+			drawCachedItem(&Item, Painter);
+		}
+	}
+
+	std::tuple<Items...> mStaticItems;
+};
+#endif // C++11
+
 #endif // QCGAUGEWIDGET_H
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Unit tests and benchmarks for QcGaugeWidget
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = tst_qcgaugewidget
+TEMPLATE = app
+CONFIG   += testcase
+
+INCLUDEPATH += ../../source
+
+SOURCES += tst_qcgaugewidget.cpp \
+    ../../source/qcgaugewidget.cpp
+
+HEADERS  += ../../source/qcgaugewidget.h
@@ -0,0 +1,1167 @@
+#include <QtTest>
+#include <QGridLayout>
+#include <QAtomicInt>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "qcgaugewidget.h"
+
+
+static QAtomicInt AllocationCount; ///< allocations while counting is enabled
+static bool CountAllocations = false;
+
+
+static inline void countAllocation()
+{
+	if (CountAllocations)
+	{
+		AllocationCount.ref();
+	}
+}
+
+
+#if defined(__GLIBC__)
+// Qt containers, strings, paths and images allocate with malloc() and
+// realloc(), not with operator new. glibc exports its allocator under
+// internal names, so the test replaces the public functions and forwards
+// to them.
+extern "C" void* __libc_malloc(size_t Size);
+extern "C" void* __libc_calloc(size_t Count, size_t Size);
+extern "C" void* __libc_realloc(void* Ptr, size_t Size);
+
+
+extern "C" void* malloc(size_t Size) __THROW
+{
+	countAllocation();
+	return __libc_malloc(Size);
+}
+
+
+extern "C" void* calloc(size_t Count, size_t Size) __THROW
+{
+	countAllocation();
+	return __libc_calloc(Count, Size);
+}
+
+
+extern "C" void* realloc(void* Ptr, size_t Size) __THROW
+{
+	countAllocation();
+	return __libc_realloc(Ptr, Size);
+}
+#endif
+
+
+void* operator new(std::size_t Size)
+{
+#if !defined(__GLIBC__)
+	// with glibc the allocation is counted by malloc()
+	countAllocation();
+#endif
+	void* Ptr = std::malloc(Size ? Size : 1);
+	if (!Ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return Ptr;
+}
+
+
+void operator delete(void* Ptr) noexcept
+{
+	std::free(Ptr);
+}
+
+
+/**
+ * Unit tests and benchmarks for the gauge widget
+ */
+class QcGaugeWidgetTest : public QObject
+{
+	Q_OBJECT
+
+private:
+	static QcGaugeWidget* createGauge(QWidget* Parent, QcNeedleItem** Needle = 0);
+
+private slots:
+	void benchmarkStartup_data();
+	void benchmarkStartup();
+	void benchmarkLayerFormats_data();
+	void benchmarkLayerFormats();
+	void benchmarkStaticGauge_data();
+	void benchmarkStaticGauge();
+	void steadyNeedlePaintDoesNotAllocate();
+	void fastNeedleMatchesQPainter_data();
+	void fastNeedleMatchesQPainter();
+	void benchmarkFastNeedle_data();
+	void benchmarkFastNeedle();
+	void benchmarkColorBand_data();
+	void benchmarkColorBand();
+	void bandedRenderingMatchesSingleBand();
+	void movingAverageMatchesWindow();
+	void benchmarkAlarmEvaluation();
+	void alarmEvaluationDoesNotAllocate();
+	void deletedAlarmBandIsReleased();
+	void rotatingDialPaintsChildItems();
+	void itemPoolsReuseSlots();
+	void rotatingDialLimitsSprites();
+	void batchValuesReachBoundModel();
+	void resetPeaksNotifiesViews();
+	void tapeKeepsExplicitFontSize();
+	void tapeScrollMatchesFreshRender();
+	void historyScrollMatchesFullRedraw();
+	void holdWindowExpires();
+	void envelopeClearsWithoutSamples();
+	void medianMatchesWindow();
+	void kernelGradientMatchesQPainter();
+};
+
+
+/**
+ * Creates a gauge with the items of the speed gauge example
+ */
+QcGaugeWidget* QcGaugeWidgetTest::createGauge(QWidget* Parent, QcNeedleItem** Needle)
+{
+	QcGaugeWidget* Gauge = new QcGaugeWidget(Parent);
+	Gauge->addBackground(99);
+	QcBackgroundItem* Background = Gauge->addBackground(92);
+	Background->clearColors();
+	Background->addColor(0.1, Qt::black);
+	Background->addColor(1.0, Qt::white);
+	Gauge->addArc(55);
+	Gauge->addDegrees(65)->setRange(0, 80);
+	Gauge->addColorBand(50);
+	Gauge->addValues(80)->setRange(0, 80);
+	Gauge->addLabel(70)->setText("Km/h");
+	QcNeedleItem* GaugeNeedle = Gauge->addNeedle(60);
+	GaugeNeedle->setColor(Qt::white);
+	GaugeNeedle->setValueRange(0, 80);
+	Gauge->addBackground(7);
+	Gauge->addGlass(88);
+	if (Needle)
+	{
+		*Needle = GaugeNeedle;
+	}
+	return Gauge;
+}
+
+
+void QcGaugeWidgetTest::benchmarkStartup_data()
+{
+	QTest::addColumn<bool>("Progressive");
+	QTest::newRow("direct") << false;
+	QTest::newRow("progressive") << true;
+}
+
+
+/**
+ * Measures the time until the first frame and until all gauges of a large
+ * dashboard are rendered
+ */
+void QcGaugeWidgetTest::benchmarkStartup()
+{
+	QFETCH(bool, Progressive);
+	const int GaugeCount = 500;
+
+	qint64 FirstFrame = -1;
+	qint64 AllRendered = -1;
+	QBENCHMARK_ONCE
+	{
+		QWidget Dashboard;
+		QGridLayout* Layout = new QGridLayout(&Dashboard);
+		QcDashboardScheduler Scheduler;
+		Scheduler.setProgressiveRendering(Progressive);
+		for (int i = 0; i < GaugeCount; ++i)
+		{
+			QcGaugeWidget* Gauge = createGauge(&Dashboard);
+			Gauge->setMinimumSize(48, 48);
+			Layout->addWidget(Gauge, i / 25, i % 25);
+			Scheduler.addGauge(Gauge);
+		}
+		Dashboard.resize(25 * 64, 20 * 64);
+		Scheduler.start();
+		Dashboard.show();
+		QVERIFY(QTest::qWaitForWindowExposed(&Dashboard));
+		QTRY_VERIFY_WITH_TIMEOUT(Scheduler.timeToAllGaugesRendered() >= 0, 60000);
+		FirstFrame = Scheduler.timeToFirstFrame();
+		AllRendered = Scheduler.timeToAllGaugesRendered();
+	}
+
+	QVERIFY(FirstFrame >= 0);
+	QVERIFY(AllRendered >= FirstFrame);
+	qDebug("time to first frame: %lld ms, time to all gauges rendered: %lld ms",
+		FirstFrame, AllRendered);
+}
+
+
+void QcGaugeWidgetTest::benchmarkLayerFormats_data()
+{
+	QTest::addColumn<bool>("Opaque");
+	QTest::addColumn<bool>("Compact");
+	QTest::newRow("ARGB32_Premultiplied") << false << false;
+	QTest::newRow("RGB32") << true << false;
+	QTest::newRow("RGB16") << true << true;
+}
+
+
+/**
+ * Measures a steady state frame for each background layer format, which
+ * includes the conversion of the layer while blitting it to the widget
+ */
+void QcGaugeWidgetTest::benchmarkLayerFormats()
+{
+	QFETCH(bool, Opaque);
+	QFETCH(bool, Compact);
+
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	Gauge->setAutoFillBackground(Opaque);
+	Gauge->setCompactLayerFormats(Compact);
+	Gauge->resize(400, 400);
+	Gauge->show();
+	QVERIFY(QTest::qWaitForWindowExposed(Gauge.data()));
+
+	QImage Frame(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	Gauge->render(&Frame);
+	int Value = 0;
+	QBENCHMARK
+	{
+		Needle->setValue(Value++ % 80);
+		Gauge->render(&Frame);
+	}
+	qDebug("cache size: %lld bytes", QcCacheManager::instance()->usage(Gauge.data()));
+}
+
+
+void QcGaugeWidgetTest::benchmarkStaticGauge_data()
+{
+	QTest::addColumn<bool>("Static");
+	QTest::newRow("QcGaugeWidget") << false;
+	QTest::newRow("QcStaticGauge") << true;
+}
+
+
+/**
+ * Compares a steady state frame of a gauge composed at run time with the
+ * same gauge composed at compile time
+ */
+void QcGaugeWidgetTest::benchmarkStaticGauge()
+{
+	QFETCH(bool, Static);
+
+	typedef QcStaticGauge<QcBackgroundItem, QcDegreesItem, QcValuesItem,
+		QcNeedleItem, QcLabelItem, QcGlassItem> StaticGauge;
+	QScopedPointer<QcGaugeWidget> Gauge;
+	QcNeedleItem* Needle = 0;
+	if (Static)
+	{
+		StaticGauge* Widget = new StaticGauge();
+		Widget->item<0>().setPosition(92);
+		Widget->item<1>().setPosition(65);
+		Widget->item<1>().setRange(0, 80);
+		Widget->item<2>().setPosition(80);
+		Widget->item<2>().setRange(0, 80);
+		Widget->item<3>().setPosition(60);
+		Widget->item<3>().setValueRange(0, 80);
+		Widget->item<4>().setPosition(70);
+		Widget->item<4>().setText("Km/h");
+		Widget->item<5>().setPosition(88);
+		Needle = &Widget->item<3>();
+		Gauge.reset(Widget);
+	}
+	else
+	{
+		QcGaugeWidget* Widget = new QcGaugeWidget();
+		Widget->addBackground(92);
+		Widget->addDegrees(65)->setRange(0, 80);
+		Widget->addValues(80)->setRange(0, 80);
+		Needle = Widget->addNeedle(60);
+		Needle->setValueRange(0, 80);
+		Widget->addLabel(70)->setText("Km/h");
+		Widget->addGlass(88);
+		Gauge.reset(Widget);
+	}
+
+	Gauge->resize(400, 400);
+	QImage Frame(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	Gauge->render(&Frame);
+	int Value = 0;
+	QBENCHMARK
+	{
+		Needle->setValue(Value++ % 80);
+		Gauge->render(&Frame);
+	}
+}
+
+
+/**
+ * Reference widget for the allocations of Qt itself. It paints like a
+ * steady state gauge frame - it blits a layer and draws a label text - but
+ * without any gauge code.
+ */
+class QcReferenceWidget : public QWidget
+{
+public:
+	QImage Layer;
+	QFont Font;
+	QString Text;
+
+protected:
+	void paintEvent(QPaintEvent*)
+	{
+		QPainter Painter(this);
+		Painter.setRenderHint(QPainter::Antialiasing);
+		Painter.drawImage(0, 0, Layer);
+		Painter.setFont(Font);
+		Painter.drawText(QRectF(rect().center(), QSizeF(0, 0)),
+			Qt::AlignCenter | Qt::TextSingleLine | Qt::TextDontClip, Text);
+	}
+};
+
+
+/**
+ * Once the caches are warm, a gauge frame for a new needle value must not
+ * allocate more memory than a widget that only blits a layer and draws a
+ * text. The counting hooks see operator new, malloc, calloc and realloc,
+ * so the allocations of Qt containers, strings, paths and images in the
+ * gauge code are counted, while the allocations of the painter and the
+ * text layout are the same for both widgets.
+ */
+void QcGaugeWidgetTest::steadyNeedlePaintDoesNotAllocate()
+{
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	Gauge->resize(400, 400);
+	QcLabelItem* Label = Gauge->addLabel(40);
+	Needle->setLabel(Label);
+	Needle->setDropShadow(false);
+
+	QcReferenceWidget Reference;
+	Reference.resize(Gauge->size());
+	Reference.Layer = QImage(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	Reference.Layer.fill(Qt::gray);
+	Reference.Font = Label->font();
+	Reference.Text = QString::number(88);
+
+	QImage Frame(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	for (int i = 0; i < 80; ++i)
+	{
+		Needle->setValue(i);
+		Gauge->render(&Frame);
+		Reference.render(&Frame);
+	}
+
+	AllocationCount.store(0);
+	CountAllocations = true;
+	for (int i = 0; i < 80; ++i)
+	{
+		Reference.render(&Frame);
+	}
+	CountAllocations = false;
+	int ReferenceAllocations = AllocationCount.load();
+
+	AllocationCount.store(0);
+	CountAllocations = true;
+	for (int i = 0; i < 80; ++i)
+	{
+		Needle->setValue(79 - i);
+		Gauge->render(&Frame);
+	}
+	CountAllocations = false;
+	int GaugeAllocations = AllocationCount.load();
+	qDebug("%d allocations in 80 frames, %d in 80 reference frames",
+		GaugeAllocations, ReferenceAllocations);
+	QVERIFY2(GaugeAllocations <= ReferenceAllocations, qPrintable(
+		QString("%1 allocations in the gauge code").arg(GaugeAllocations - ReferenceAllocations)));
+}
+
+
+void QcGaugeWidgetTest::fastNeedleMatchesQPainter_data()
+{
+	QTest::addColumn<int>("NeedleType");
+	QTest::addColumn<bool>("Gradient");
+	QTest::newRow("triangle") << int(QcNeedleItem::TriangleNeedle) << false;
+	QTest::newRow("feather") << int(QcNeedleItem::FeatherNeedle) << false;
+	QTest::newRow("diamond") << int(QcNeedleItem::DiamonNeedle) << false;
+	QTest::newRow("compass gradient") << int(QcNeedleItem::CompassNeedle) << true;
+}
+
+
+/**
+ * The rasterized needle must match the needle painted with QPainter up to
+ * small antialiasing differences at the edges
+ */
+void QcGaugeWidgetTest::fastNeedleMatchesQPainter()
+{
+	QFETCH(int, NeedleType);
+	QFETCH(bool, Gradient);
+
+	QcNeedleItem* Needles[2];
+	QScopedPointer<QcGaugeWidget> Reference(createGauge(0, &Needles[0]));
+	QScopedPointer<QcGaugeWidget> Fast(createGauge(0, &Needles[1]));
+	Fast->setFastNeedleRendering(true);
+	for (int i = 0; i < 2; ++i)
+	{
+		Needles[i]->setNeedle(static_cast<QcNeedleItem::NeedleType>(NeedleType));
+		Needles[i]->setDropShadow(false);
+		if (!Gradient)
+		{
+			Needles[i]->setColor(QColor(255, 64, 0));
+		}
+	}
+	Reference->resize(300, 300);
+	Fast->resize(300, 300);
+
+	QImage Expected(Reference->size(), QImage::Format_ARGB32_Premultiplied);
+	QImage Actual(Fast->size(), QImage::Format_ARGB32_Premultiplied);
+	for (int Value = 0; Value <= 80; Value += 7)
+	{
+		Needles[0]->setValue(Value);
+		Needles[1]->setValue(Value);
+		Expected.fill(Qt::transparent);
+		Actual.fill(Qt::transparent);
+		Reference->render(&Expected);
+		Fast->render(&Actual);
+
+		qint64 Sum = 0;
+		int MaxDiff = 0;
+		for (int y = 0; y < Expected.height(); ++y)
+		{
+			const QRgb* e = reinterpret_cast<const QRgb*>(Expected.constScanLine(y));
+			const QRgb* a = reinterpret_cast<const QRgb*>(Actual.constScanLine(y));
+			for (int x = 0; x < Expected.width(); ++x)
+			{
+				int Diff = qMax(qMax(qAbs(qRed(e[x]) - qRed(a[x])), qAbs(qGreen(e[x]) - qGreen(a[x]))),
+					qMax(qAbs(qBlue(e[x]) - qBlue(a[x])), qAbs(qAlpha(e[x]) - qAlpha(a[x]))));
+				Sum += Diff;
+				MaxDiff = qMax(MaxDiff, Diff);
+			}
+		}
+		double MeanDiff = double(Sum) / (Expected.width() * Expected.height());
+		QVERIFY2(MaxDiff <= 64, qPrintable(QString("value %1: max diff %2").arg(Value).arg(MaxDiff)));
+		QVERIFY2(MeanDiff < 0.5, qPrintable(QString("value %1: mean diff %2").arg(Value).arg(MeanDiff)));
+	}
+}
+
+
+void QcGaugeWidgetTest::benchmarkFastNeedle_data()
+{
+	QTest::addColumn<bool>("FastNeedle");
+	QTest::newRow("QPainter") << false;
+	QTest::newRow("rasterizer") << true;
+}
+
+
+/**
+ * Measures a steady state frame of a large gauge with the needle painted
+ * by QPainter and by the needle rasterizer
+ */
+void QcGaugeWidgetTest::benchmarkFastNeedle()
+{
+	QFETCH(bool, FastNeedle);
+
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	Gauge->setFastNeedleRendering(FastNeedle);
+	Needle->setDropShadow(false);
+	Gauge->resize(800, 800);
+	QImage Frame(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	Gauge->render(&Frame);
+	int Value = 0;
+	QBENCHMARK
+	{
+		Needle->setValue(Value++ % 80);
+		Gauge->render(&Frame);
+	}
+}
+
+
+void QcGaugeWidgetTest::benchmarkColorBand_data()
+{
+	QTest::addColumn<int>("Format");
+	QTest::newRow("QPainter") << int(QImage::Format_ARGB32);
+	QTest::newRow("ring kernel") << int(QImage::Format_ARGB32_Premultiplied);
+}
+
+
+/**
+ * Compares drawing a color band with many sub bands with the ring kernel
+ * and with stroked QPainter paths. The ring kernel is only used for
+ * premultiplied images.
+ */
+void QcGaugeWidgetTest::benchmarkColorBand()
+{
+	QFETCH(int, Format);
+
+	QcGaugeWidget Gauge;
+	Gauge.resize(800, 800);
+	QcColorBand* Band = Gauge.addColorBand(80);
+	QList<QPair<QColor, double> > Colors;
+	for (int i = 1; i <= 20; ++i)
+	{
+		Colors.append(qMakePair(QColor::fromHsv(i * 17, 255, 255), i * 5.0));
+	}
+	Band->setColors(Colors);
+
+	QImage Image(Gauge.size(), static_cast<QImage::Format>(Format));
+	QBENCHMARK
+	{
+		Image.fill(Qt::transparent);
+		QPainter Painter(&Image);
+		Painter.setRenderHint(QPainter::Antialiasing);
+		Band->draw(&Painter);
+	}
+}
+
+
+/**
+ * Rendering the retained item images in parallel bands must give the same
+ * image as rendering them in one piece
+ */
+void QcGaugeWidgetTest::bandedRenderingMatchesSingleBand()
+{
+	QScopedPointer<QcGaugeWidget> Single(createGauge(0));
+	QScopedPointer<QcGaugeWidget> Banded(createGauge(0));
+	Single->setParallelRenderingThreshold(0);
+	Banded->setParallelRenderingThreshold(1);
+	Single->resize(1024, 1024);
+	Banded->resize(1024, 1024);
+
+	QImage Expected(Single->size(), QImage::Format_ARGB32_Premultiplied);
+	QImage Actual(Banded->size(), QImage::Format_ARGB32_Premultiplied);
+	Expected.fill(Qt::transparent);
+	Actual.fill(Qt::transparent);
+	Single->render(&Expected);
+	Banded->render(&Actual);
+
+	QCOMPARE(Actual, Expected);
+}
+
+
+/**
+ * The running sum of the moving average must give the mean of the last
+ * window samples across batches of any size
+ */
+void QcGaugeWidgetTest::movingAverageMatchesWindow()
+{
+	const int Window = 7;
+	QcSampleFilter Filter(QcSampleFilter::MovingAverage, Window);
+	QVector<double> Samples(1000);
+	for (int i = 0; i < Samples.size(); ++i)
+	{
+		Samples[i] = 1e6 + sin(i * 0.37) * 50 + (i % 13);
+	}
+
+	QVector<double> Output(Samples.size());
+	for (int Start = 0, Batch = 1; Start < Samples.size(); Start += Batch, ++Batch)
+	{
+		int Count = qMin(Batch, Samples.size() - Start);
+		Filter.process(Samples.constData() + Start, Output.data() + Start, Count);
+	}
+
+	for (int i = 0; i < Samples.size(); ++i)
+	{
+		int First = qMax(0, i - Window + 1);
+		double Sum = 0;
+		for (int j = First; j <= i; ++j)
+		{
+			Sum += Samples.at(j);
+		}
+		QVERIFY(qAbs(Output.at(i) - Sum / (i - First + 1)) < 1e-6);
+	}
+}
+
+
+/**
+ * Creates a band with zones every 10 units and alarms in the lowest and
+ * the two highest zones
+ */
+static QcColorBand* createAlarmBand(QcGaugeWidget* Gauge)
+{
+	QcColorBand* Band = Gauge->addColorBand(80);
+	QList<QPair<QColor, double> > Colors;
+	for (int i = 1; i <= 10; ++i)
+	{
+		Colors.append(qMakePair(QColor::fromHsv(i * 30, 255, 255), i * 10.0));
+	}
+	Band->setColors(Colors);
+	Band->setAlarmZones(0x601);
+	Band->setAlarmHysteresis(0.5);
+	return Band;
+}
+
+
+/**
+ * Measures the alarm evaluation of a band. The evaluation is designed for
+ * more than 10 million samples per second in a release build.
+ */
+void QcGaugeWidgetTest::benchmarkAlarmEvaluation()
+{
+	QcGaugeWidget Gauge;
+	QcColorBand* Band = createAlarmBand(&Gauge);
+	const int Count = 1 << 20;
+	QVector<double> Values(Count);
+	for (int i = 0; i < Count; ++i)
+	{
+		// mostly steady values with a zone change every 1000 samples
+		Values[i] = (i / 1000 % 10) * 10 + 5 + sin(i * 0.1);
+	}
+
+	QBENCHMARK
+	{
+		Band->evaluateAlarms(Values.constData(), Count, 0);
+	}
+}
+
+
+/**
+ * Evaluating samples, recording transitions and switching the flashing
+ * overlay must not allocate memory once the alarm state exists
+ */
+void QcGaugeWidgetTest::alarmEvaluationDoesNotAllocate()
+{
+	QcGaugeWidget Gauge;
+	QcColorBand* Band = createAlarmBand(&Gauge);
+	Band->setAlarmFlashing(true);
+	double Values[200];
+	for (int i = 0; i < 200; ++i)
+	{
+		Values[i] = (i % 20) * 5.0 + 1;
+	}
+	Band->evaluateAlarms(Values, 200, 0);
+
+	QcAlarmEvent Events[64];
+	AllocationCount.store(0);
+	CountAllocations = true;
+	int Transitions = 0;
+	for (int i = 0; i < 10; ++i)
+	{
+		Transitions += Band->evaluateAlarms(Values, 200, i);
+		Band->takeAlarmEvents(Events, 64);
+	}
+	CountAllocations = false;
+	QVERIFY(Transitions > 0);
+	QCOMPARE(AllocationCount.load(), 0);
+}
+
+
+/**
+ * A needle must stop the evaluation against its alarm band when the band
+ * is deleted
+ */
+void QcGaugeWidgetTest::deletedAlarmBandIsReleased()
+{
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	QcColorBand* Band = createAlarmBand(Gauge.data());
+	Needle->setAlarmBand(Band);
+	Needle->setValue(75);
+	QCOMPARE(Band->alarmZone(), 7);
+
+	Gauge->removeItem(Band);
+	delete Band;
+	QVERIFY(!Needle->alarmBand());
+	Needle->setValue(5);
+}
+
+
+/**
+ * A rotating dial with child items must paint at any heading and release
+ * its children with the widget
+ */
+void QcGaugeWidgetTest::rotatingDialPaintsChildItems()
+{
+	for (int Step = 0; Step <= 5; Step += 5)
+	{
+		QScopedPointer<QcGaugeWidget> Gauge(new QcGaugeWidget);
+		Gauge->resize(300, 300);
+		Gauge->addBackground(99);
+		QcRotatingDialItem* Dial = Gauge->addRotatingDial(90);
+		Dial->addArc(80);
+		Dial->addDegrees(75)->setRange(0, 360);
+		Dial->addValues(65)->setRange(0, 360);
+		Dial->addColorBand(50);
+		Dial->addLabel(30)->setText("N");
+		QCOMPARE(Dial->items().size(), 5);
+		Dial->setRotationStep(Step);
+
+		QImage Frame(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+		QImage First;
+		for (int Heading = 0; Heading <= 360; Heading += 45)
+		{
+			Dial->setValue(Heading);
+			Frame.fill(Qt::transparent);
+			Gauge->render(&Frame);
+			if (Heading == 0)
+			{
+				First = Frame.copy();
+			}
+			else if (Heading == 360)
+			{
+				// a full turn of a quantized dial blits the unrotated sprite
+				if (Step > 0)
+				{
+					QCOMPARE(Frame, First);
+				}
+			}
+			else
+			{
+				QVERIFY(Frame != First);
+			}
+		}
+	}
+}
+
+
+/**
+ * Items created by the add functions share per-type pools of the widget.
+ * The slot of a deleted item is reused and removed items may outlive the
+ * widget.
+ */
+void QcGaugeWidgetTest::itemPoolsReuseSlots()
+{
+	QcLabelItem* Removed = 0;
+	{
+		QcGaugeWidget Gauge;
+		QcNeedleItem* First = Gauge.addNeedle(60);
+		QcNeedleItem* Second = Gauge.addNeedle(60);
+		QVERIFY(First != Second);
+		Gauge.removeItem(First);
+		delete First;
+		QcNeedleItem* Third = Gauge.addNeedle(60);
+		QCOMPARE(Third, First);
+
+		for (int i = 0; i < 200; ++i)
+		{
+			Gauge.addDegrees(65);
+		}
+		QCOMPARE(Gauge.items().size(), 202);
+		Removed = Gauge.addLabel(70);
+		Gauge.removeItem(Removed);
+	}
+	delete Removed;
+
+	QcNeedleItem* HeapNeedle = 0;
+	{
+		QcGaugeWidget Gauge;
+		HeapNeedle = new QcNeedleItem(&Gauge);
+		Gauge.addItem(HeapNeedle, 60);
+		Gauge.removeItem(HeapNeedle);
+	}
+	delete HeapNeedle;
+}
+
+
+/**
+ * The sprites of a quantized dial must stay within their byte limit when
+ * the dial turns through all angles
+ */
+void QcGaugeWidgetTest::rotatingDialLimitsSprites()
+{
+	QcGaugeWidget Gauge;
+	Gauge.resize(1000, 1000);
+	QcRotatingDialItem* Dial = Gauge.addRotatingDial(90);
+	Dial->addDegrees(75)->setRange(0, 360);
+	Dial->setRotationStep(1);
+
+	QImage Frame(Gauge.size(), QImage::Format_ARGB32_Premultiplied);
+	for (int Heading = 0; Heading < 360; ++Heading)
+	{
+		Dial->setValue(Heading);
+		Gauge.render(&Frame);
+	}
+	// 32 MB of sprites plus the layers and the dial image - without the
+	// limit the 360 sprites would take 1.4 GB
+	QVERIFY2(Gauge.cacheSize() < 64 * 1024 * 1024,
+		qPrintable(QString("%1 bytes").arg(Gauge.cacheSize())));
+}
+
+
+/**
+ * The batch update must write the value of a model-bound needle into its
+ * model channel instead of the needle
+ */
+void QcGaugeWidgetTest::batchValuesReachBoundModel()
+{
+	QcGaugeModel Model;
+	int Channel = Model.addChannel(0, 80);
+	QcNeedleItem* Bound = 0;
+	QcNeedleItem* Free = 0;
+	QScopedPointer<QcGaugeWidget> First(createGauge(0, &Bound));
+	QScopedPointer<QcGaugeWidget> Second(createGauge(0, &Free));
+	Bound->setModel(&Model, Channel);
+
+	QcNeedleItem* Needles[2] = {Bound, Free};
+	double Values[2] = {42, 17};
+	QcNeedleItem::setValues(Needles, Values, 2);
+	QCOMPARE(Model.value(Channel), 42.0);
+	QCOMPARE(Bound->value(), 42.0);
+	QCOMPARE(Free->value(), 17.0);
+
+	QImage Frame(First->size(), QImage::Format_ARGB32_Premultiplied);
+	First->render(&Frame);
+	QCOMPARE(Bound->value(), 42.0);
+}
+
+
+/**
+ * Resetting the peaks of a channel must notify the bound views
+ */
+void QcGaugeWidgetTest::resetPeaksNotifiesViews()
+{
+	QcGaugeModel Model;
+	int Channel = Model.addChannel(0, 100);
+	Model.setValue(Channel, 90);
+	Model.setValue(Channel, 40);
+	QCOMPARE(Model.peak(Channel), 90.0);
+
+	QSignalSpy Changed(&Model, SIGNAL(changed()));
+	quint64 Revision = Model.revision();
+	Model.resetPeaks(Channel);
+	QCOMPARE(Changed.count(), 1);
+	QVERIFY(Model.revision() != Revision);
+	QCOMPARE(Model.peak(Channel), 40.0);
+	QCOMPARE(Model.trough(Channel), 40.0);
+}
+
+
+/**
+ * Creates a gauge with a tape
+ */
+static QcGaugeWidget* createTapeGauge(QcTapeItem** Tape)
+{
+	QcGaugeWidget* Gauge = new QcGaugeWidget;
+	Gauge->resize(400, 400);
+	Gauge->addBackground(99);
+	*Tape = Gauge->addTape(90);
+	(*Tape)->setStep(5);
+	(*Tape)->setLabelStep(20);
+	return Gauge;
+}
+
+
+/**
+ * A font with an explicit size must be used as it is, a font without a
+ * size scales with the tape
+ */
+void QcGaugeWidgetTest::tapeKeepsExplicitFontSize()
+{
+	QcTapeItem* Small = 0;
+	QcTapeItem* Large = 0;
+	QScopedPointer<QcGaugeWidget> SmallGauge(createTapeGauge(&Small));
+	QScopedPointer<QcGaugeWidget> LargeGauge(createTapeGauge(&Large));
+	QFont SmallFont;
+	SmallFont.setPointSize(6);
+	QFont LargeFont;
+	LargeFont.setPointSize(30);
+	Small->setFont(SmallFont);
+	Large->setFont(LargeFont);
+
+	QImage SmallFrame(SmallGauge->size(), QImage::Format_ARGB32_Premultiplied);
+	QImage LargeFrame(LargeGauge->size(), QImage::Format_ARGB32_Premultiplied);
+	SmallFrame.fill(Qt::transparent);
+	LargeFrame.fill(Qt::transparent);
+	SmallGauge->render(&SmallFrame);
+	LargeGauge->render(&LargeFrame);
+	QCOMPARE(Small->font().pointSize(), 6);
+	QCOMPARE(Large->font().pointSize(), 30);
+	QVERIFY(SmallFrame != LargeFrame);
+
+	// a default font is scaled for the strips without changing font()
+	QcTapeItem* Scaled = 0;
+	QScopedPointer<QcGaugeWidget> ScaledGauge(createTapeGauge(&Scaled));
+	Scaled->setFont(QFont(QString("Sans")));
+	QFont Before = Scaled->font();
+	ScaledGauge->render(&SmallFrame);
+	QCOMPARE(Scaled->font(), Before);
+}
+
+
+/**
+ * Scrolling the tape through several chunks must show the same pixels as
+ * a tape that renders the value from scratch
+ */
+void QcGaugeWidgetTest::tapeScrollMatchesFreshRender()
+{
+	QcTapeItem* Scrolled = 0;
+	QScopedPointer<QcGaugeWidget> ScrolledGauge(createTapeGauge(&Scrolled));
+	QImage Actual(ScrolledGauge->size(), QImage::Format_ARGB32_Premultiplied);
+	for (int Value = -150; Value <= 350; Value += 7)
+	{
+		Scrolled->setValue(Value);
+		Actual.fill(Qt::transparent);
+		ScrolledGauge->render(&Actual);
+	}
+
+	QcTapeItem* Fresh = 0;
+	QScopedPointer<QcGaugeWidget> FreshGauge(createTapeGauge(&Fresh));
+	Fresh->setValue(Scrolled->value());
+	QImage Expected(FreshGauge->size(), QImage::Format_ARGB32_Premultiplied);
+	Expected.fill(Qt::transparent);
+	FreshGauge->render(&Expected);
+	QCOMPARE(Actual, Expected);
+}
+
+
+/**
+ * History item with a manual clock
+ */
+class QcManualHistory : public QcHistoryItem
+{
+public:
+	explicit QcManualHistory(QcGaugeWidget* Gauge) : QcHistoryItem(Gauge), Now(0) {}
+	qint64 Now; ///< current time in milliseconds
+
+protected:
+	qint64 currentTime() const {return Now;}
+};
+
+
+/**
+ * The trace scrolled column by column over a wrapped ring buffer must
+ * show the same pixels as a trace that is redrawn completely
+ */
+void QcGaugeWidgetTest::historyScrollMatchesFullRedraw()
+{
+	QcGaugeWidget Gauge;
+	Gauge.resize(400, 400);
+	QcManualHistory* History = new QcManualHistory(&Gauge);
+	Gauge.addItem(History, 100);
+	History->setTimeSpan(1);
+	History->setRange(-1, 1);
+	// 128 samples cover the visible second at 100 samples per second, and
+	// the 500 samples wrap the ring buffer several times
+	History->setCapacity(128);
+
+	QImage Actual(Gauge.size(), QImage::Format_ARGB32_Premultiplied);
+	for (int i = 0; i < 500; ++i)
+	{
+		History->Now = i * 10;
+		History->addSample(sin(i * 0.2));
+		if (i % 3 == 0)
+		{
+			Actual.fill(Qt::transparent);
+			Gauge.render(&Actual);
+		}
+	}
+	History->Now += 25;
+	Actual.fill(Qt::transparent);
+	Gauge.render(&Actual);
+
+	Gauge.releaseCaches();
+	QImage Expected(Gauge.size(), QImage::Format_ARGB32_Premultiplied);
+	Expected.fill(Qt::transparent);
+	Gauge.render(&Expected);
+	QCOMPARE(Actual, Expected);
+
+	// after the samples left the visible span the scrolled trace is empty
+	History->Now += 2000;
+	Actual.fill(Qt::transparent);
+	Gauge.render(&Actual);
+	History->clear();
+	Expected.fill(Qt::transparent);
+	Gauge.render(&Expected);
+	QCOMPARE(Actual, Expected);
+}
+
+
+/**
+ * The hold markers must follow a window over the last samples and expire
+ * by time without new samples
+ */
+void QcGaugeWidgetTest::holdWindowExpires()
+{
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	Needle->setPeakHold(true);
+	Needle->setMinimumHold(true);
+
+	// window over the last three samples
+	Needle->setHoldWindow(0, 3);
+	double Values[5] = {50, 70, 20, 30, 10};
+	Needle->addSamples(Values, 3);
+	QCOMPARE(Needle->heldPeak(), 70.0);
+	QCOMPARE(Needle->heldMinimum(), 20.0);
+	Needle->addSamples(Values + 3, 2);
+	QCOMPARE(Needle->heldPeak(), 30.0);
+	QCOMPARE(Needle->heldMinimum(), 10.0);
+
+	// a time window expires on the repaint that the gauge schedules itself
+	Needle->resetHold();
+	Needle->setHoldWindow(200);
+	Gauge->show();
+	QVERIFY(QTest::qWaitForWindowExposed(Gauge.data()));
+	QElapsedTimer Timer;
+	Timer.start();
+	Needle->setValue(70);
+	Needle->setValue(20);
+	QTest::qWait(50);
+	QCOMPARE(Needle->heldPeak(), 70.0);
+	QTRY_COMPARE_WITH_TIMEOUT(Needle->heldPeak(), 20.0, 2000);
+	QVERIFY(Timer.elapsed() >= 200);
+}
+
+
+/**
+ * Counts the paint events of a widget
+ */
+class QcPaintCounter : public QObject
+{
+public:
+	int Paints;
+
+	QcPaintCounter() : Paints(0) {}
+
+protected:
+	bool eventFilter(QObject*, QEvent* Event)
+	{
+		if (Event->type() == QEvent::Paint)
+		{
+			Paints++;
+		}
+		return false;
+	}
+};
+
+
+/**
+ * The envelope shows the samples between two frames. Once the samples
+ * stop, the next frame must look like a gauge that never had an envelope
+ * and the gauge must schedule that frame itself.
+ */
+void QcGaugeWidgetTest::envelopeClearsWithoutSamples()
+{
+	QcNeedleItem* Needle = 0;
+	QScopedPointer<QcGaugeWidget> Gauge(createGauge(0, &Needle));
+	Gauge->resize(300, 300);
+	Needle->setEnvelope(true);
+	QcNeedleItem* ReferenceNeedle = 0;
+	QScopedPointer<QcGaugeWidget> Reference(createGauge(0, &ReferenceNeedle));
+	Reference->resize(300, 300);
+	ReferenceNeedle->setEnvelope(true);
+
+	QImage Expected(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	QImage Actual(Gauge->size(), QImage::Format_ARGB32_Premultiplied);
+	ReferenceNeedle->setValue(40);
+	Reference->render(&Expected);
+	Reference->render(&Expected);
+	Needle->setValue(10);
+	Needle->setValue(70);
+	Needle->setValue(40);
+	Gauge->render(&Actual);
+	QVERIFY(Actual != Expected);
+	Gauge->render(&Actual);
+	QCOMPARE(Actual, Expected);
+
+	QcPaintCounter Counter;
+	Gauge->installEventFilter(&Counter);
+	Gauge->show();
+	QVERIFY(QTest::qWaitForWindowExposed(Gauge.data()));
+	QTest::qWait(50);
+	int Paints = Counter.Paints;
+	Needle->setValue(10);
+	Needle->setValue(70);
+	Needle->setValue(40);
+	QTRY_VERIFY_WITH_TIMEOUT(Counter.Paints >= Paints + 2, 1000);
+}
+
+
+/**
+ * The median of the sorted window must match the median of the last
+ * samples for batches of any size, also when the filter runs in place
+ */
+void QcGaugeWidgetTest::medianMatchesWindow()
+{
+	const int Window = 9;
+	QcSampleFilter Filter(QcSampleFilter::Median, Window);
+	QVector<double> Samples(1000);
+	for (int i = 0; i < Samples.size(); ++i)
+	{
+		Samples[i] = sin(i * 0.37) * 50 + (i * 7919 % 31);
+	}
+
+	QVector<double> Output = Samples;
+	for (int Start = 0, Batch = 1; Start < Output.size(); Start += Batch, ++Batch)
+	{
+		int Count = qMin(Batch, Output.size() - Start);
+		Filter.process(Output.constData() + Start, Output.data() + Start, Count);
+	}
+
+	for (int i = 0; i < Samples.size(); ++i)
+	{
+		int First = qMax(0, i - Window + 1);
+		QVector<double> Values = Samples.mid(First, i - First + 1);
+		std::sort(Values.begin(), Values.end());
+		QCOMPARE(Output.at(i), Values.at(Values.size() / 2));
+	}
+}
+
+
+/**
+ * The ring kernel must fill a gradient disc like QPainter, also for
+ * gradients between stops with different alpha values
+ */
+void QcGaugeWidgetTest::kernelGradientMatchesQPainter()
+{
+	QcGaugeWidget Gauge;
+	QcBackgroundItem* Background = Gauge.addBackground(90);
+	Background->clearColors();
+	Background->addColor(0.0, QColor(255, 0, 0, 0));
+	Background->addColor(0.5, QColor(0, 255, 0, 96));
+	Background->addColor(1.0, QColor(0, 0, 255, 255));
+	Gauge.resize(300, 300);
+
+	QImage Actual(Gauge.size(), QImage::Format_ARGB32_Premultiplied);
+	Actual.fill(Qt::transparent);
+	Gauge.render(&Actual);
+
+	QImage Expected(Gauge.size(), QImage::Format_ARGB32_Premultiplied);
+	Expected.fill(Qt::transparent);
+	{
+		QRectF Rect = Background->widgetRect();
+		QLinearGradient Gradient(Rect.topLeft(), Rect.bottomRight());
+		Gradient.setColorAt(0.0, QColor(255, 0, 0, 0));
+		Gradient.setColorAt(0.5, QColor(0, 255, 0, 96));
+		Gradient.setColorAt(1.0, QColor(0, 0, 255, 255));
+		QPainter Painter(&Expected);
+		Painter.setRenderHint(QPainter::Antialiasing);
+		Painter.setPen(Qt::NoPen);
+		Painter.setBrush(Gradient);
+		Painter.drawEllipse(Background->itemRect());
+	}
+
+	qint64 Sum = 0;
+	int MaxDiff = 0;
+	for (int y = 0; y < Expected.height(); ++y)
+	{
+		const QRgb* e = reinterpret_cast<const QRgb*>(Expected.constScanLine(y));
+		const QRgb* a = reinterpret_cast<const QRgb*>(Actual.constScanLine(y));
+		for (int x = 0; x < Expected.width(); ++x)
+		{
+			int Diff = qMax(qMax(qAbs(qRed(e[x]) - qRed(a[x])), qAbs(qGreen(e[x]) - qGreen(a[x]))),
+				qMax(qAbs(qBlue(e[x]) - qBlue(a[x])), qAbs(qAlpha(e[x]) - qAlpha(a[x]))));
+			Sum += Diff;
+			MaxDiff = qMax(MaxDiff, Diff);
+		}
+	}
+	double MeanDiff = double(Sum) / (Expected.width() * Expected.height());
+	QVERIFY2(MaxDiff <= 64, qPrintable(QString("max diff %1").arg(MaxDiff)));
+	QVERIFY2(MeanDiff < 0.5, qPrintable(QString("mean diff %1").arg(MeanDiff)));
+
+	// inside the disc only the rounding of the gradient tables differs
+	QPoint Center = Background->itemRect().center().toPoint();
+	for (int Offset = -60; Offset <= 60; Offset += 20)
+	{
+		int x = Center.x() + Offset;
+		int y = Center.y() + Offset;
+		QRgb e = reinterpret_cast<const QRgb*>(Expected.constScanLine(y))[x];
+		QRgb a = reinterpret_cast<const QRgb*>(Actual.constScanLine(y))[x];
+		QVERIFY(qAbs(qRed(e) - qRed(a)) <= 3 && qAbs(qGreen(e) - qGreen(a)) <= 3
+			&& qAbs(qBlue(e) - qBlue(a)) <= 3 && qAbs(qAlpha(e) - qAlpha(a)) <= 3);
+	}
+}
+
+
+QTEST_MAIN(QcGaugeWidgetTest)
+#include "tst_qcgaugewidget.moc"